@@ -0,0 +1,117 @@
+#ifndef WORKLOADS_HPP
+#define WORKLOADS_HPP
+
+    #include <random>
+    #include <string>
+    #include <vector>
+
+    /*
+        Synthetic .avm programs for the benchmarks. Every workload is deterministic for a seed,
+        has about `instructions` instructions and ends with exit. Values stay small, so no
+        workload fails on an overflow whatever its length.
+            chain-<type>    long arithmetic chain on one operand type
+            promotion       blocks that climb from int8 to double, one promotion per operation
+            deep-dump       deep stack printed by frequent dumps
+            comments        a few instructions lost in comment lines and trailing comments
+    */
+    inline const std::vector<std::string>& workloadNames() {
+        static const std::vector<std::string> names = {
+            "chain-int8", "chain-int16", "chain-int32", "chain-float", "chain-double",
+            "promotion", "deep-dump", "comments",
+        };
+        return names;
+    }
+
+    inline std::string chainWorkload(const std::string& type, size_t instructions, std::mt19937& random) {
+        bool floating = (type == "float" || type == "double");
+        std::string text = "push " + type + "(1)\n";
+        size_t emitted = 1;
+
+        /*
+            The pushed value is the left operand: push k; sub computes k - top.
+            add k then sub k negates the value, two such pairs give back 1, then mul 1 and div 1.
+        */
+        std::string value;
+        for (size_t step = 0; emitted + 2 <= instructions; step++) {
+            if (step % 2 == 0) {
+                value = floating ? std::to_string(random() % 9 + 1) + ".25" : std::to_string(random() % 9 + 1);
+            }
+
+            switch (step % 6) {
+                case 0: case 2: text += "push " + type + "(" + value + ")\nadd\n"; break;
+                case 1: case 3: text += "push " + type + "(" + value + ")\nsub\n"; break;
+                case 4:         text += "push " + type + "(1)\nmul\n"; break;
+                default:        text += "push " + type + "(1)\ndiv\n"; break;
+            }
+            emitted += 2;
+        }
+        return text;
+    }
+
+    inline std::string promotionWorkload(size_t instructions) {
+        static const char BLOCK[] =
+            "push int8(1)\npush int16(2)\nadd\npush int32(3)\nmul\npush float(1.5)\nadd\npush double(0.5)\nsub\npop\n";
+        const size_t blockInstructions = 10;
+        std::string text;
+
+        for (size_t emitted = 0; emitted + blockInstructions <= instructions; emitted += blockInstructions) {
+            text += BLOCK;
+        }
+        return text;
+    }
+
+    inline std::string deepDumpWorkload(size_t instructions, std::mt19937& random) {
+        const size_t depth = 2000;
+        const size_t dumpEvery = 500;
+        std::string text;
+        size_t emitted = 0;
+
+        while (emitted + 2 * depth + depth / dumpEvery <= instructions) {
+            for (size_t i = 1; i <= depth; i++) {
+                text += "push int32(" + std::to_string(random() % 1000) + ")\n";
+                if (i % dumpEvery == 0) {
+                    text += "dump\n";
+                }
+            }
+            for (size_t i = 0; i < depth; i++) {
+                text += "pop\n";
+            }
+            emitted += 2 * depth + depth / dumpEvery;
+        }
+        return text;
+    }
+
+    inline std::string commentsWorkload(size_t instructions, std::mt19937& random) {
+        std::string text;
+
+        for (size_t emitted = 0; emitted + 4 <= instructions; emitted += 4) {
+            text += "; ------------------------------------------\n";
+            text += ";   block " + std::to_string(emitted / 4) + ": adds two values and drops the result\n";
+            text += "; ------------------------------------------\n\n";
+            text += "push int32(" + std::to_string(random() % 100) + ")    ; first operand\n";
+            text += "push int32(" + std::to_string(random() % 100) + ")    ; second operand\n";
+            text += "add               ; sum of both\n";
+            text += "pop               ; not needed anymore\n";
+        }
+        return text;
+    }
+
+    // Source of the named workload, an empty string if the name is unknown
+    inline std::string generateWorkload(const std::string& name, size_t instructions, unsigned seed = 42) {
+        std::mt19937 random(seed);
+        std::string text;
+
+        if (name.compare(0, 6, "chain-") == 0) {
+            text = chainWorkload(name.substr(6), instructions, random);
+        } else if (name == "promotion") {
+            text = promotionWorkload(instructions);
+        } else if (name == "deep-dump") {
+            text = deepDumpWorkload(instructions, random);
+        } else if (name == "comments") {
+            text = commentsWorkload(instructions, random);
+        } else {
+            return text;
+        }
+        return text + "exit\n";
+    }
+#endif
@@ -0,0 +1,61 @@
+#include "../include/MyAbstractVm.hpp"
+#include <chrono>
+
+/*
+    Dispatch benchmark: runs a long arithmetic sequence (push int32(3); add; push int32(3); sub ...)
+    and reports how many instructions per second the execution loop gets through.
+    Usage: bench_dispatch [instructions] [runs]
+*/
+static Program arithmeticSequence(size_t length) {
+    Program program;
+    Instruction instruction = {};
+
+    instruction.opcode = Push;
+    instruction.immediate.i32 = 1;
+    program.append(instruction);
+
+    for (size_t i = 1; i + 1 < length; i += 2) {
+        instruction = {};
+        instruction.opcode = Push;
+        instruction.type = Int32;
+        instruction.immediate.i32 = 3;
+        instruction.line = i;
+        program.append(instruction);
+
+        instruction = {};
+        instruction.opcode = (i / 2) % 2 ? Sub : Add;
+        instruction.line = i + 1;
+        program.append(instruction);
+    }
+
+    return program;
+}
+
+int main(int argc, char* argv[]) {
+    size_t length = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t runs = argc > 2 ? std::stoul(argv[2]) : 20;
+
+    Program program = arithmeticSequence(length);
+    double best = 0;
+
+    for (size_t run = 0; run < runs; run++) {
+        MyAbstractVM vm;
+
+        auto start = std::chrono::steady_clock::now();
+        vm.run(program.data(), program.size());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double rate = program.size() / elapsed.count();
+        if (rate > best) {
+            best = rate;
+        }
+    }
+
+#ifdef AVM_SWITCH_DISPATCH
+    const char* dispatch = "switch";
+#else
+    const char* dispatch = "threaded";
+#endif
+    printf("%-10s %zu instructions x %zu runs: %.1f M instructions/s (best run)\n", dispatch, program.size(), runs, best / 1e6);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "../include/Lexer.hpp"
+#include "../include/Compiler.hpp"
+#include <chrono>
+#include <map>
+
+/*
+    Parser microbenchmark: recognition of mnemonics and type names, the previous
+    std::map + chain of string comparisons against the Lexer DFA, then the whole
+    compile of a line. Usage: bench_parser [lines] [runs]
+*/
+static const char* const SAMPLE[] = {
+    "push int8(42)", "push int16(1000)", "push int32(42)", "push float(44.55)", "push double(42.42)",
+    "add", "sub", "mul", "div", "mod", "pop", "dump", "print", "assert int32(75)", "exit",
+};
+
+// the lookup of the previous InstructionParser, kept as the reference
+struct MapLookup {
+    std::map<std::string, eInstructionType> instructionTypeMap = {
+        {"push", Push}, {"pop", Pop}, {"dump", Dump},
+        {"assert", Assert}, {"add", Add}, {"sub", Sub},
+        {"mul", Mul}, {"div", Div}, {"mod", Mod},
+        {"print", Print}, {"exit", Exit}, {";", Nil},
+    };
+
+    int lookup(const std::string& mnemonic, const std::string& type) const {
+        int result = instructionTypeMap.find(mnemonic)->second;
+
+        if (type.empty()) {
+            return result;
+        } else if (type == "int8") {
+            return result + Int8;
+        } else if (type == "int16") {
+            return result + Int16;
+        } else if (type == "int32") {
+            return result + Int32;
+        } else if (type == "float") {
+            return result + Float;
+        }
+        return result + Double;
+    }
+};
+
+template <typename Function>
+static double linesPerSecond(size_t lines, size_t runs, Function function) {
+    double best = 0;
+
+    for (size_t run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, lines / elapsed.count());
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t runs = argc > 2 ? std::stoul(argv[2]) : 5;
+    const size_t samples = sizeof(SAMPLE) / sizeof(SAMPLE[0]);
+
+    std::vector<std::string> lines, mnemonics, types;
+    for (size_t i = 0; i < count; i++) {
+        std::string line = SAMPLE[(i * 7) % samples];
+        size_t space = line.find(' ');
+        size_t paren = line.find('(');
+
+        lines.push_back(line);
+        mnemonics.push_back(line.substr(0, space));
+        types.push_back(space == std::string::npos ? "" : line.substr(space + 1, paren - space - 1));
+    }
+
+    volatile int sink = 0;
+    MapLookup reference;
+
+    double mapRate = linesPerSecond(count, runs, [&]() {
+        int total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += reference.lookup(mnemonics[i], types[i]);
+        }
+        sink = total;
+    });
+
+    double lexerRate = linesPerSecond(count, runs, [&]() {
+        int total = 0;
+        for (size_t i = 0; i < count; i++) {
+            eInstructionType instruction = Nil;
+            eOperandType type = Int8;
+
+            matchInstruction(mnemonics[i], instruction);
+            if (!types[i].empty()) {
+                matchOperandType(types[i], type);
+            }
+            total += instruction + (types[i].empty() ? 0 : type);
+        }
+        sink = total;
+    });
+
+    double compileRate = linesPerSecond(count, runs, [&]() {
+        Compiler compiler;
+        Program program;
+        for (size_t i = 0; i < count; i++) {
+            compiler.compileLine(lines[i], i + 1, program);
+        }
+        sink = program.size();
+    });
+
+    printf("opcode/type lookup, std::map + compares: %8.1f M lines/s\n", mapRate / 1e6);
+    printf("opcode/type lookup, lexer DFA:           %8.1f M lines/s (x%.1f)\n", lexerRate / 1e6, lexerRate / mapRate);
+    printf("full compile of a line:                  %8.1f M lines/s\n", compileRate / 1e6);
+    return 0;
+}
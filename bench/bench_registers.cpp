@@ -0,0 +1,94 @@
+#include "./Workloads.hpp"
+#include "../include/MyAbstractVm.hpp"
+#include "../include/Compiler.hpp"
+#include "../include/RegisterTranslator.hpp"
+#include <algorithm>
+#include <chrono>
+
+/*
+    Stack interpreter against the register form of the same programs. For each workload:
+        stack ms        best run of MyAbstractVM::run on the compiled program
+        register ms     best run of the register form, translated once before the runs
+        translate ms    translation to registers, best run
+        instr/reg       stack instructions per register instruction
+    The programs run as written (not optimized), so that the arithmetic chains are not folded away,
+    and their output goes to memory: a workload whose two outputs differ is reported.
+    Usage: bench_registers [instructions] [runs]
+*/
+using Clock = std::chrono::steady_clock;
+
+static double milliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/*
+    Counted loop with straight-line arithmetic on the counter in its body: the branch at its end
+    compares two values of the block, which never go back to the stack in the register form
+*/
+static std::string loopWorkload(size_t instructions) {
+    const size_t bodyInstructions = 16;
+    std::string text = "push int32(" + std::to_string(instructions / bodyInstructions + 1) + ")\n";
+
+    text += "loop:\n"
+            "dup\npush int32(7)\nswap\nmod\n"           // counter % 7
+            "push int32(3)\nmul\npush int32(1)\nadd\n"  // * 3 + 1
+            "push int32(2)\nsub\npop\n"                 // 2 - that, dropped
+            "push int32(-1)\nadd\n"                     // counter - 1
+            "dup\npush int32(0)\njlt loop\n"            // while 0 < counter
+            "pop\nexit\n";
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    size_t instructions = argc > 1 ? std::stoul(argv[1]) : 200000;
+    size_t runs = argc > 2 ? std::stoul(argv[2]) : 15;
+
+    std::vector<std::pair<std::string, std::string>> workloads;
+    for (const char* name : {"chain-int32", "chain-double", "promotion", "deep-dump"}) {
+        workloads.emplace_back(name, generateWorkload(name, instructions));
+    }
+    workloads.emplace_back("loop", loopWorkload(instructions));
+
+    printf("%-14s %10s %12s %9s %13s %10s\n", "workload", "stack ms", "register ms", "speedup", "translate ms", "instr/reg");
+
+    for (const auto& workload : workloads) {
+        Compiler compiler;
+        RegisterTranslator translator;
+        Program program = compiler.compileBuffer(workload.second, 1);
+        RegisterProgram registers;
+
+        double bestTranslate = 1e30;
+        for (size_t run = 0; run < runs; run++) {
+            Clock::time_point start = Clock::now();
+            registers = translator.translate(program);
+            bestTranslate = std::min(bestTranslate, milliseconds(start));
+        }
+
+        double bestStack = 1e30;
+        double bestRegisters = 1e30;
+        MemorySink stackOutput;
+        MemorySink registerOutput;
+
+        for (size_t run = 0; run < runs; run++) {
+            MyAbstractVM stackVm;
+            MyAbstractVM registerVm;
+
+            stackOutput.clear();
+            stackVm.setOutput(stackOutput);
+            Clock::time_point start = Clock::now();
+            stackVm.run(program.data(), program.size());
+            bestStack = std::min(bestStack, milliseconds(start));
+
+            registerOutput.clear();
+            registerVm.setOutput(registerOutput);
+            start = Clock::now();
+            registerVm.run(registers);
+            bestRegisters = std::min(bestRegisters, milliseconds(start));
+        }
+
+        printf("%-14s %10.2f %12.2f %8.2fx %13.2f %10.2f%s\n", workload.first.c_str(), bestStack, bestRegisters,
+               bestStack / bestRegisters, bestTranslate, static_cast<double>(program.size()) / registers.size(),
+               stackOutput.str() == registerOutput.str() ? "" : "  OUTPUT DIFFERS");
+    }
+    return 0;
+}
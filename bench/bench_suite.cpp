@@ -0,0 +1,79 @@
+#include "./Workloads.hpp"
+#include "../include/MyAbstractVm.hpp"
+#include "../include/Compiler.hpp"
+#include "../include/Optimizer.hpp"
+#include <algorithm>
+#include <chrono>
+
+/*
+    Benchmark suite over the synthetic workloads of Workloads.hpp. For each workload:
+        parse MB/s      compile of the source text on one thread, best run
+        M instr/s       execution of the compiled program as written (not optimized), best run
+        p50/p90/p99     latency of the whole pipeline (compile, optimize, run) over every run
+    The output of the programs goes to memory. Same instructions and runs give comparable numbers
+    across versions. Usage: bench_suite [instructions] [runs]
+*/
+using Clock = std::chrono::steady_clock;
+
+static double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> samples, double rank) {
+    std::sort(samples.begin(), samples.end());
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(rank * samples.size()));
+    return samples[index];
+}
+
+int main(int argc, char* argv[]) {
+    size_t instructions = argc > 1 ? std::stoul(argv[1]) : 200000;
+    size_t runs = argc > 2 ? std::stoul(argv[2]) : 15;
+
+    printf("%-14s %9s %9s %11s %11s %10s %10s %10s\n",
+           "workload", "MB", "instr", "parse MB/s", "M instr/s", "p50 ms", "p90 ms", "p99 ms");
+
+    for (const std::string& name : workloadNames()) {
+        std::string text = generateWorkload(name, instructions);
+        Compiler compiler;
+        Optimizer optimizer;
+        MemorySink output;
+
+        double bestParse = 0;
+        double bestRun = 0;
+        size_t executed = 0;
+        std::vector<double> latencies;
+
+        for (size_t run = 0; run < runs; run++) {
+            MyAbstractVM vm;
+            vm.setOutput(output);
+
+            Clock::time_point start = Clock::now();
+            Program program = compiler.compileBuffer(text, 1);
+            double parse = seconds(start);
+
+            Clock::time_point execution = Clock::now();
+            vm.run(program.data(), program.size());
+            double runTime = seconds(execution);
+
+            bestParse = std::max(bestParse, text.size() / parse);
+            bestRun = std::max(bestRun, program.size() / runTime);
+            executed = program.size();
+            output.clear();
+
+            // what a user of the CLI waits for
+            MyAbstractVM pipelineVm;
+            pipelineVm.setOutput(output);
+
+            Clock::time_point pipeline = Clock::now();
+            Program optimized = optimizer.optimize(compiler.compileBuffer(text, 1));
+            pipelineVm.run(optimized.data(), optimized.size());
+            latencies.push_back(seconds(pipeline) * 1e3);
+            output.clear();
+        }
+
+        printf("%-14s %9.2f %9zu %11.1f %11.1f %10.3f %10.3f %10.3f\n",
+               name.c_str(), text.size() / 1e6, executed, bestParse / 1e6, bestRun / 1e6,
+               percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99));
+    }
+    return 0;
+}
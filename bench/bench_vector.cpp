@@ -0,0 +1,79 @@
+#include "../include/MyAbstractVm.hpp"
+#include <chrono>
+#include <random>
+
+/*
+    Vector instruction benchmark: sum of a stack of n int32 or double values, with a chain of
+    n - 1 add as the reference, then with the kernels of every level the CPU supports.
+    Every level must give the same result, the benchmark fails if one does not.
+    Usage: bench_vector [values] [runs]
+*/
+using Clock = std::chrono::steady_clock;
+
+static std::vector<Value> randomValues(eOperandType type, size_t count) {
+    std::mt19937 random(42);
+    std::vector<Value> values;
+
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(type == Int32 ? Value::make<Int32>(random() % 1000) : Value::make<Double>(random() % 100000 / 7.0));
+    }
+    return values;
+}
+
+// Best time of `runs` sums, the stack is filled again before each one (not timed)
+template <typename Function>
+static double bestSeconds(MyAbstractVM& vm, const std::vector<Value>& values, size_t runs, Value& result, Function sum) {
+    double best = 0;
+
+    for (size_t run = 0; run < runs; run++) {
+        vm.reset();
+        for (const Value& value : values) {
+            vm.push(value);
+        }
+
+        Clock::time_point start = Clock::now();
+        sum();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        best = (run == 0 || elapsed < best) ? elapsed : best;
+        result = vm.getStack().top();
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 65536;
+    size_t runs = argc > 2 ? std::stoul(argv[2]) : 50;
+    const eOperandType types[] = {Int32, Double};
+
+    for (eOperandType type : types) {
+        std::vector<Value> values = randomValues(type, count);
+        MyAbstractVM vm(count);
+        Value chained, reference;
+
+        double chain = bestSeconds(vm, values, runs, chained, [&vm]() {
+            while (vm.getStack().size() > 1) {
+                vm.add();
+            }
+        });
+        printf("%-6s %zu values, chain of add: %8.3f ms\n", type == Int32 ? "int32" : "double", count, chain * 1e3);
+
+        for (int level = VectorKernels::Scalar; level <= VectorKernels::supportedLevel(); level++) {
+            const VectorKernels& kernels = VectorKernels::forLevel(static_cast<VectorKernels::eLevel>(level));
+            Value result;
+
+            vm.setVectorKernels(kernels);
+            double seconds = bestSeconds(vm, values, runs, result, [&vm]() { vm.sum(); });
+
+            if (level == VectorKernels::Scalar) {
+                reference = result;
+            } else if (!(result == reference)) {
+                printf("%s gives %s, scalar gives %s\n", kernels.name, result.toString().c_str(), reference.toString().c_str());
+                return 1;
+            }
+            printf("%-6s %zu values, sum (%-6s): %8.3f ms (x%.1f)\n", type == Int32 ? "int32" : "double", count,
+                   kernels.name, seconds * 1e3, chain / seconds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "./Workloads.hpp"
+#include <iostream>
+
+/*
+    Writes a synthetic workload to stdout, to keep a benchmark input as a file.
+    Usage: generate_workload <name> [instructions] [seed]
+*/
+int main(int argc, char* argv[]) {
+    std::string name = argc > 1 ? argv[1] : "";
+    size_t instructions = argc > 2 ? std::stoul(argv[2]) : 100000;
+    unsigned seed = argc > 3 ? std::stoul(argv[3]) : 42;
+
+    std::string text = generateWorkload(name, instructions, seed);
+    if (text.empty()) {
+        std::cerr << "usage: generate_workload <name> [instructions] [seed], names:";
+        for (const std::string& workload : workloadNames()) {
+            std::cerr << " " << workload;
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    std::cout << text;
+    return 0;
+}
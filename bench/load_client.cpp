@@ -0,0 +1,118 @@
+#include "./Workloads.hpp"
+#include "../include/VmServer.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+/*
+    Load generator for --serve. Each connection is a thread with its own client that sends the
+    program, waits for its reply, and sends it again, until requests programs ran in total.
+    Reports the throughput and the p50/p90/p99 latency of a request, seen from the client.
+    The program is a .avm file or a workload of Workloads.hpp with 50 instructions, the size of a
+    typical script. Without a socket the server runs in this process, on a temporary socket.
+    Usage: load_client [requests] [connections] [program.avm|workload] [socket]
+*/
+using Clock = std::chrono::steady_clock;
+
+static const size_t PROGRAM_INSTRUCTIONS = 50;
+
+static double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> samples, double rank) {
+    std::sort(samples.begin(), samples.end());
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(rank * samples.size()));
+    return samples[index];
+}
+
+static std::string loadProgram(const std::string& name) {
+    std::string text = generateWorkload(name, PROGRAM_INSTRUCTIONS);
+
+    if (text.empty()) {
+        std::ifstream file(name);
+        std::stringstream content;
+
+        if (!file) {
+            throw InvalidFile();
+        }
+        content << file.rdbuf();
+        text = content.str();
+    }
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t connections = argc > 2 ? std::max(1ul, std::stoul(argv[2])) : 8;
+    std::string program = loadProgram(argc > 3 ? argv[3] : "promotion");
+    std::string socketPath = argc > 4 ? argv[4] : "/tmp/load_client." + std::to_string(getpid()) + ".sock";
+
+    std::unique_ptr<VmServer> server;
+    std::thread serverThread;
+    if (argc <= 4) {
+        server.reset(new VmServer(socketPath));
+        serverThread = std::thread([&server] { server->run(); });
+    }
+
+    // every thread records its own latencies, merged at the end
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<size_t> failures(connections, 0);
+    std::vector<std::thread> clients;
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < connections; i++) {
+        size_t share = requests / connections + (i < requests % connections ? 1 : 0);
+
+        clients.emplace_back([&, i, share] {
+            // the embedded server may not be listening yet
+            std::unique_ptr<VmClient> client;
+            for (int attempt = 0; !client; attempt++) {
+                try {
+                    client.reset(new VmClient(socketPath));
+                } catch (const SocketError&) {
+                    if (attempt == 1000) {
+                        throw;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            for (size_t request = 0; request < share; request++) {
+                Clock::time_point sent = Clock::now();
+                ServerReply reply = client->run(program);
+
+                latencies[i].push_back(seconds(sent) * 1e6);
+                failures[i] += reply.result.status == Failed;
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    double elapsed = seconds(start);
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+    }
+
+    std::vector<double> all;
+    size_t failed = 0;
+    for (size_t i = 0; i < connections; i++) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        failed += failures[i];
+    }
+    if (all.empty()) {
+        return 0;
+    }
+
+    printf("%10s %12s %11s %10s %10s %10s %8s\n",
+           "requests", "connections", "req/s", "p50 us", "p90 us", "p99 us", "failed");
+    printf("%10zu %12zu %11.0f %10.1f %10.1f %10.1f %8zu\n",
+           all.size(), connections, all.size() / elapsed,
+           percentile(all, 0.50), percentile(all, 0.90), percentile(all, 0.99), failed);
+    return failed ? 1 : 0;
+}
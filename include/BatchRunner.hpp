@@ -0,0 +1,47 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+    #include "./VmInstance.hpp"
+    #include <string>
+    #include <vector>
+
+    // Result of one program of a batch
+    struct BatchResult {
+        std::string fileName;
+        RunResult   result;
+        std::string output;
+    };
+
+    /*
+        Runs many independent programs across cores.
+        Each worker thread owns its VmInstance (VM, compiler, output), nothing is shared but the
+        work queues and the prefix cache when one is set. The files are split between per-worker
+        queues; a worker that runs out of work steals from the back of the others.
+        Results are stored by input index, so they come back in the order of the input.
+    */
+    class BatchRunner {
+        public:
+            // threads == 0 uses one thread per core
+            explicit BatchRunner(size_t threads = 0);
+
+            std::vector<BatchResult>        run(const std::vector<std::string>& files);
+
+            /*
+                Programs named by source:
+                    - a directory: every .avm and .avmc file in it
+                    - a glob pattern (containing *, ? or [): every matching path
+                    - any other file: a manifest listing one path per line, relative to the manifest
+                Paths are sorted, except for a manifest which keeps its own order.
+            */
+            static std::vector<std::string> collectFiles(const std::string& source);
+
+            size_t                          threadCount() const { return threads; }
+
+            // Shared by every worker, nullptr (the default) runs every program from its first line
+            void                            setPrefixCache(PrefixCache* cache) { prefixCache = cache; }
+
+        private:
+            size_t          threads;
+            PrefixCache*    prefixCache = nullptr;
+    };
+#endif
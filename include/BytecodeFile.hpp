@@ -0,0 +1,55 @@
+#ifndef BYTECODE_FILE_HPP
+#define BYTECODE_FILE_HPP
+
+    #include "./Program.hpp"
+    #include "./Exceptions.hpp"
+    #include "./MappedFile.hpp"
+    #include <stdint.h>
+    #include <string>
+
+    // Bumped every time the layout of Instruction or the meaning of an opcode changes
+    const uint16_t AVMC_VERSION = 5;
+
+    /*
+        Header of a .avmc file. It is followed by `count` Instruction records,
+        stored exactly as they are in memory so they can be run from the mapped pages.
+    */
+    struct BytecodeHeader {
+        char        magic[4];           // "AVMC"
+        uint16_t    version;
+        uint16_t    instructionSize;    // sizeof(Instruction) of the writer
+        uint32_t    flags;
+        uint32_t    reserved;
+        uint64_t    count;
+        uint64_t    checksum;           // FNV-1a of the instruction records
+    };
+
+    static_assert(sizeof(BytecodeHeader) == 32, "BytecodeHeader must stay 32 bytes");
+
+    const uint32_t AVMC_HAS_EXIT = 1;
+
+    // A compiled program mapped from a .avmc file, valid as long as the object lives
+    class BytecodeFile {
+        public:
+            // Maps the file and checks its header and checksum, throws InvalidBytecode if anything is wrong
+            explicit BytecodeFile(const std::string& fileName);
+
+            BytecodeFile(const BytecodeFile&) = delete;
+            BytecodeFile& operator=(const BytecodeFile&) = delete;
+
+            const Instruction*  data() const { return code; }
+            size_t              size() const { return count; }
+            bool                hasExit() const { return _hasExit; }
+
+            static void         write(const std::string& fileName, const Program& program);
+
+            // True if the file starts with the .avmc magic
+            static bool         isBytecode(const std::string& fileName);
+
+        private:
+            MappedFile          file;
+            const Instruction*  code = nullptr;
+            size_t              count = 0;
+            bool                _hasExit = false;
+    };
+#endif
@@ -0,0 +1,89 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+    #include "./Lexer.hpp"
+    #include "./Program.hpp"
+    #include <istream>
+    #include <map>
+    #include <string>
+    #include <string_view>
+    #include <unordered_map>
+    #include <vector>
+
+    /*
+        Turns .avm source into a Program. The text is parsed once here,
+        running the program afterwards does not touch any string.
+    */
+    class Compiler {
+        public:
+            // Compiles the whole stream like compileBuffer
+            Program compile(std::istream& input);
+
+            /*
+                Compiles one source line, returns true if an instruction was appended. Allocates nothing
+                but the room of the instruction in the program, and the names of labels and jumps.
+                The target of a jump is only set by link().
+            */
+            bool compileLine(std::string_view line, uint32_t lineNumber, Program& program);
+
+            /*
+                Sets the target of every jump to the index of its label. A jump to an undefined label
+                throws UnknownLabel on its line, unless partial: it then stays in program.jumps() until
+                its label is compiled (stream and interactive modes). A label defined twice throws
+                DuplicateLabel.
+            */
+            void link(Program& program, bool partial = false);
+
+            /*
+                Compiles and links a whole text. Lines never depend on each other (labels are only
+                resolved by link), so a big text is split in chunks at newline boundaries that are
+                tokenized and validated in parallel, then stitched back in order with their global
+                line numbers. threads == 0 uses one thread per core.
+
+                Nothing after the first exit is kept, unless a jump before it goes to a label defined
+                after it (a function written after the exit): then the whole text is the program.
+            */
+            Program compileBuffer(std::string_view text, size_t threads = 0);
+
+            // True when a jump before the first exit goes to a label that is not defined before it
+            static bool jumpsPastExit(const Program& program);
+
+            // Maps the file and compiles it with compileBuffer
+            Program compileFile(const std::string& fileName, size_t threads = 0);
+
+        private:
+            // Below this size a chunk is not worth a thread
+            static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+    };
+
+    /*
+        Links a program while it is compiled line by line (interactive mode). Each update only
+        looks at the labels and jumps compiled since the last one: a new label sets the target of
+        the jumps waiting for it, a new jump gets its target if its label is already known. So a
+        line costs the jumps it resolves, not a pass over the whole program like link(program, true).
+
+        The jumps are taken out of program.jumps(), use linkedSize() of the linker to know what can run.
+    */
+    class IncrementalLinker {
+        public:
+            // Links the new labels and jumps, a label defined twice throws DuplicateLabel on its line
+            void    update(Program& program);
+
+            // The input ended: the first jump still waiting for its label throws UnknownLabel on its line
+            void    finish() const;
+
+            // A jump before the first exit still waits for its label, which can only come after the exit
+            bool    jumpsPastExit(const Program& program) const {
+                return program.hasExit() && !pending.empty() && pending.begin()->first < program.firstExit();
+            }
+
+            // The instructions before the first jump without a target yet
+            size_t  linkedSize(const Program& program) const { return pending.empty() ? program.size() : pending.begin()->first; }
+
+        private:
+            std::unordered_map<std::string, uint32_t>               targets;    // pc of each label
+            std::unordered_map<std::string, std::vector<uint32_t>>  waiting;    // pcs of the jumps to each unknown label
+            std::map<uint32_t, uint32_t>                            pending;    // line of each jump waiting, by pc
+            size_t                                                  labels = 0; // labels of the program already read
+    };
+#endif
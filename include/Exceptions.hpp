@@ -26,6 +26,38 @@
             }
     };
 
+    // .avmc file with a wrong header, version or checksum
+    class InvalidBytecode : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Invalid or corrupted bytecode file";
+            }
+    };
+
+    // Snapshot with a wrong header, version or checksum, or taken on another program
+    class InvalidSnapshot : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Invalid or corrupted snapshot, or snapshot of another program";
+            }
+    };
+
+    // --serve socket that cannot be set up, or a connection to the server that broke
+    class SocketError : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Socket operation failed";
+            }
+    };
+
+    // -j, --prefix-cache or the line of --checkpoint without a value, with a value that is not a number or out of its range, or an unknown option
+    class InvalidOption : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Invalid option, -j takes 1 to 1024 threads, --prefix-cache 1 to 65536 MB and --checkpoint a line from 1";
+            }
+    };
+
     // push, div...
     class InvalidInstruction : public std::exception {
         public:
@@ -70,10 +102,74 @@
             }
     };
 
+    class NotEnoughValues : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Not enough values on the stack for vector operation.";
+            }
+    };
+
     class AssertError : public std::exception {
         public:
             const char* what() const noexcept override {
                 return "Error: Assertion failed.";
             }
     };
+
+    // jmp, call... to a label that the program never defines
+    class UnknownLabel : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Jump to an undefined label.";
+            }
+    };
+
+    class DuplicateLabel : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Label defined twice.";
+            }
+    };
+
+    class ReturnWithoutCall : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: ret without a matching call.";
+            }
+    };
+
+    // Too deep recursion of call
+    class CallStackOverflow : public std::exception {
+        public:
+            const char* what() const noexcept override {
+                return "Error: Call stack overflow.";
+            }
+    };
+
+    // Wraps one of the errors above with the line of the program that raised it
+    class ProgramError : public std::exception {
+        public:
+            ProgramError(size_t line, const std::exception& cause) : ProgramError(line, std::string(cause.what())) {}
+
+            ProgramError(size_t line, const std::string& cause)
+                : _line(line), _cause(cause), _message("Line " + std::to_string(line) + ": " + cause) {}
+
+            const char* what() const noexcept override {
+                return _message.c_str();
+            }
+
+            size_t line() const {
+                return _line;
+            }
+
+            // Message of the wrapped error, without the line
+            const std::string& cause() const {
+                return _cause;
+            }
+
+        private:
+            size_t      _line;
+            std::string _cause;
+            std::string _message;
+    };
 #endif
\ No newline at end of file
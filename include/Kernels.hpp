@@ -0,0 +1,48 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+    #include "./Value.hpp"
+    #include <array>
+    #include <utility>
+
+    // The result of an operation has the type of its operand of higher precision
+    constexpr eOperandType promotedType(eOperandType lhs, eOperandType rhs) {
+        return lhs > rhs ? lhs : rhs;
+    }
+
+    /*
+        Arithmetic kernel for one (lhs type, rhs type, operation) triple.
+        Promotion, the conversion of the operands and the overflow check are all resolved at
+        compile time, so a mixed int8 + double costs the same as a double + double.
+    */
+    template <eOperandType Lhs, eOperandType Rhs, eArithOp Op>
+    Value arithKernel(const Value& lhs, const Value& rhs) {
+        constexpr eOperandType Result = promotedType(Lhs, Rhs);
+        using T = typename OperandTraits<Result>::type;
+
+        T left = static_cast<T>(OperandTraits<Lhs>::get(lhs.raw));
+        T right = static_cast<T>(OperandTraits<Rhs>::get(rhs.raw));
+
+        return Value::make<Result>(checkedArith<Op>(left, right));
+    }
+
+    using ArithKernel = Value (*)(const Value&, const Value&);
+
+    const size_t OPERAND_TYPES = 5;
+    const size_t ARITH_OPS = 5;
+
+    template <size_t... Index>
+    constexpr std::array<ArithKernel, sizeof...(Index)> makeArithKernels(std::index_sequence<Index...>) {
+        return {{ &arithKernel<static_cast<eOperandType>(Index / (OPERAND_TYPES * ARITH_OPS)),
+                               static_cast<eOperandType>(Index / ARITH_OPS % OPERAND_TYPES),
+                               static_cast<eArithOp>(Index % ARITH_OPS)>... }};
+    }
+
+    // Every kernel, indexed by [lhs type][rhs type][operation]
+    inline constexpr std::array<ArithKernel, OPERAND_TYPES * OPERAND_TYPES * ARITH_OPS> arithKernels =
+        makeArithKernels(std::make_index_sequence<OPERAND_TYPES * OPERAND_TYPES * ARITH_OPS>());
+
+    inline ArithKernel findArithKernel(eOperandType lhs, eOperandType rhs, eArithOp op) {
+        return arithKernels[(lhs * OPERAND_TYPES + rhs) * ARITH_OPS + op];
+    }
+#endif
@@ -0,0 +1,230 @@
+#ifndef LEXER_HPP
+#define LEXER_HPP
+
+    #include "./Program.hpp"
+    #include <algorithm>
+    #include <string_view>
+
+    /*
+        Text front end of the compiler. Nothing here allocates: tokens are slices of the line
+        (or of the mapped file) and numbers are parsed in place.
+
+        Recognition of mnemonics and type names:
+        The words are few and short, so a hand-rolled DFA is enough: switch on the length,
+        then on one distinguishing character, then a single comparison confirms the word.
+    */
+
+    // Returns false if word is not an instruction, ";" is the comment marker (Nil)
+    inline bool matchInstruction(std::string_view word, eInstructionType& type) {
+        switch (word.size()) {
+            case 1:
+                if (word[0] == ';') {
+                    type = Nil;
+                    return true;
+                }
+                return false;
+            case 3:
+                switch (word[0]) {
+                    case 'p': type = Pop; return word == "pop";
+                    case 'a': type = Add; return word == "add";
+                    case 's':
+                        type = word[2] == 'b' ? Sub : Sum;
+                        return word == "sub" || word == "sum";
+                    case 'd':
+                        type = word[1] == 'i' ? Div : Dup;
+                        return word == "div" || word == "dup";
+                    case 'm':
+                        type = word[2] == 'l' ? Mul : Mod;
+                        return word == "mul" || word == "mod";
+                    case 'r': type = Ret; return word == "ret";
+                    case 'j':
+                        switch (word[1]) {
+                            case 'm': type = Jmp; break;
+                            case 'e': type = Jeq; break;
+                            case 'n': type = Jne; break;
+                            case 'l': type = word[2] == 't' ? Jlt : Jle; break;
+                            case 'g': type = word[2] == 't' ? Jgt : Jge; break;
+                            default:  return false;
+                        }
+                        return word == instructionName(type);
+                    default:  return false;
+                }
+            case 4:
+                switch (word[0]) {
+                    case 'p': type = Push; return word == "push";
+                    case 'd': type = Dump; return word == "dump";
+                    case 'e': type = Exit; return word == "exit";
+                    case 'a': type = AddN; return word == "addn";
+                    case 'm': type = MulPairs; return word == "mulp";
+                    case 's': type = Swap; return word == "swap";
+                    case 'c': type = Call; return word == "call";
+                    default:  return false;
+                }
+            case 5:
+                type = Print;
+                return word == "print";
+            case 6:
+                type = Assert;
+                return word == "assert";
+            default:
+                return false;
+        }
+    }
+
+    // Returns false if word is not one of int8, int16, int32, float, double
+    inline bool matchOperandType(std::string_view word, eOperandType& type) {
+        switch (word.size()) {
+            case 4:
+                type = Int8;
+                return word == "int8";
+            case 5:
+                switch (word[3]) {
+                    case '1': type = Int16; return word == "int16";
+                    case '3': type = Int32; return word == "int32";
+                    case 'a': type = Float; return word == "float";
+                    default:  return false;
+                }
+            case 6:
+                type = Double;
+                return word == "double";
+            default:
+                return false;
+        }
+    }
+
+    // Instructions written with a type(value) operand
+    inline bool takesOperand(eInstructionType instruction) {
+        return instruction == Push || instruction == Assert || instruction == AddN || instruction == MulPairs;
+    }
+
+    // Slices of one source line, e.g. "push int32(42)" gives mnemonic "push", type "int32", value "42"
+    struct LineTokens {
+        eInstructionType    instruction = Nil;      // Nil for a blank, comment or label only line
+        std::string_view    type;                   // empty when the instruction has no operand
+        std::string_view    value;
+        bool                hasOperand = false;
+        std::string_view    label;                  // "loop" for a line that starts with "loop:"
+        std::string_view    target;                 // label operand of a jump or a call
+    };
+
+    // A label is a letter or '_' followed by letters, digits and '_'
+    inline bool isValidLabel(std::string_view name) {
+        if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+            return false;
+        }
+        for (char c : name) {
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A value is an optional '-' followed by digits with at most one '.'
+    inline bool isValidOperandValue(std::string_view value) {
+        if (value.empty()) {
+            return false;
+        }
+
+        bool hasDot = false;
+
+        for (size_t j = 0; j < value.size(); j++) {
+            if (j == 0 && value[j] == '-') {
+                continue;
+            }
+            // decimal values
+            if (value[j] == '.') {
+                if (hasDot) {
+                    return false;
+                }
+                hasDot = true;
+            } else if (value[j] < '0' || value[j] > '9') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+        Splits a line into its label, instruction and operand.
+        Leading blanks and a trailing comment are ignored, a line starting with ";;" is an exit.
+        Words are separated by single spaces, throws InvalidInstruction for an unknown mnemonic
+        or an invalid label, and InvalidOperandType for an operand that is not type(value) or,
+        for a jump, a label.
+    */
+    inline LineTokens tokenizeLine(std::string_view line) {
+        LineTokens tokens;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos) {
+            return tokens;
+        }
+        line.remove_prefix(start);
+
+        if (line[0] == ';') {
+            if (line.size() > 1 && line[1] == ';') {
+                tokens.instruction = Exit;
+            }
+            return tokens;
+        }
+
+        // drop a trailing comment and the blanks before it
+        line = line.substr(0, line.find(';'));
+        line = line.substr(0, line.find_last_not_of(" \t\r") + 1);
+
+        size_t space = line.find(' ');
+        std::string_view word = line.substr(0, space);
+
+        // "loop:" alone or before the instruction it stands for
+        if (word.back() == ':') {
+            tokens.label = word.substr(0, word.size() - 1);
+            if (!isValidLabel(tokens.label)) {
+                throw InvalidInstruction();
+            }
+            line = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+            line.remove_prefix(std::min(line.size(), line.find_first_not_of(" \t")));
+            if (line.empty()) {
+                return tokens;
+            }
+            space = line.find(' ');
+        }
+
+        if (!matchInstruction(line.substr(0, space), tokens.instruction)) {
+            throw InvalidInstruction();
+        }
+        if (isJump(tokens.instruction)) {
+            tokens.target = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+            if (!isValidLabel(tokens.target)) {
+                throw InvalidOperandType();
+            }
+            return tokens;
+        }
+        if (space == std::string_view::npos) {
+            return tokens;
+        }
+
+        // operand, e.g. int32(42)
+        std::string_view rest = line.substr(space + 1);
+        size_t nextSpace = rest.find(' ');
+        std::string_view operand = rest.substr(0, nextSpace);
+
+        size_t open = operand.find('(');
+        size_t close = open == std::string_view::npos ? open : operand.find(')', open);
+        if (close == std::string_view::npos) {
+            throw InvalidOperandType();
+        }
+
+        tokens.type = operand.substr(0, open);
+        tokens.value = operand.substr(open + 1, close - open - 1);
+        tokens.hasOperand = true;
+
+        if (!isValidOperandValue(tokens.value)) {
+            throw InvalidOperandType();
+        }
+        // push, assert, addn and mulp take exactly one operand
+        if (nextSpace != std::string_view::npos && takesOperand(tokens.instruction)) {
+            throw InvalidOperandType();
+        }
+        return tokens;
+    }
+#endif
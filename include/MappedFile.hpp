@@ -0,0 +1,26 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+    #include "./Exceptions.hpp"
+    #include <string>
+    #include <string_view>
+
+    // Read-only mapping of a whole file, unmapped when the object is destroyed
+    class MappedFile {
+        public:
+            // Throws InvalidFile if the file cannot be opened or mapped
+            explicit MappedFile(const std::string& fileName);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const char*         data() const { return _data; }
+            size_t              size() const { return _size; }
+            std::string_view    text() const { return std::string_view(_data, _size); }
+
+        private:
+            const char* _data = nullptr;
+            size_t      _size = 0;
+    };
+#endif
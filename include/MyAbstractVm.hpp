@@ -1,8 +1,17 @@
 #ifndef MY_ABSTRACT_VM_H
 #define MY_ABSTRACT_VM_H
 
-    #include "./IOperand.hpp"
+    #include "./Value.hpp"
     #include "./Exceptions.hpp"
+    #include "./Program.hpp"
+    #include "./RegisterProgram.hpp"
+    #include "./ValueStack.hpp"
+    #include "./Kernels.hpp"
+    #include "./OutputSink.hpp"
+    #include "./PairCounter.hpp"
+    #include "./Profiler.hpp"
+    #include "./VectorKernels.hpp"
+    #include <unistd.h>
     #include <iostream>
     #include <stack>
     #include <stdio.h>
@@ -11,61 +20,23 @@
     #include <map>
     #include <float.h>
     #include <math.h>
-    #include <functional>
     #include <fstream>
     #include <exception>
     
-    // Instructions that we can use to create the different variables
-    enum eInstructionType { Push, Pop, Dump, Assert, Add, Sub, Mul, Div, Mod, Print, Exit, Nil };
-
-    // Class to create the operands
-    class OperandFactory {
-        public:
-            IOperand* createOperand(eOperandType type, std::string& value) {
-                return (this->*createFuncs[type])(value);
-            }
-
-            IOperand* createInt8(std::string& value) {
-                return new class Int8(value);
-            }
-
-            IOperand* createInt16(std::string& value) {
-                return new class Int16(value);
-            };
-
-            IOperand* createInt32(std::string& value){
-                return new class Int32(value);
-            };
-
-            IOperand* createFloat(std::string& value){
-                return new class Float(value);
-            };
-
-            IOperand* createDouble(std::string& value){
-                return new class Double(value);
-            };
-
-        private:
-            // In order to choose the right member function for the creation of the new IOperand, you MUST create and use an array of pointers on member functions with enum values as index.
-            using CreateOperand = IOperand* (OperandFactory::*)(std::string&);
-
-            // Array indices point (or jump) to the functions assigned to them.
-            CreateOperand createFuncs[5] = {
-                &OperandFactory::createInt8,
-                &OperandFactory::createInt16,
-                &OperandFactory::createInt32,
-                &OperandFactory::createFloat,
-                &OperandFactory::createDouble,
-            };
-    };
+    // How a call to MyAbstractVM::run ended
+    enum eRunStatus { Completed, Exited, Failed };
 
     // Class that implement a stack and use the different math operations to create, store and use the different variables that we can now create
     class MyAbstractVM {
         public:
-            MyAbstractVM() {}
+            explicit MyAbstractVM(size_t stackCapacity = ValueStack::DEFAULT_CAPACITY) : stack(stackCapacity) {}
 
             void push(std::string& value, eOperandType type) {
-                stack.push(factory.createOperand(type, value));
+                stack.push(parseValue(type, value));
+            };
+
+            void push(const Value& value) {
+                stack.push(value);
             };
 
             void pop() {
@@ -81,13 +52,12 @@
                 Each value is separated from the next one by a newline.
             */
             void dump() const {
-                std::stack<IOperand*> temp = stack;
+                char buffer[32];
 
-                while(!temp.empty()) {
-                    IOperand* value = temp.top();
-                    std::cout << value->toString() << std::endl;
-                    temp.pop();
-                }
+                stack.forEachFromTop([this, &buffer](const Value& value) {
+                    output->write(buffer, value.format(buffer, sizeof(buffer)));
+                    output->put('\n');
+                });
             }
 
             /*
@@ -95,13 +65,17 @@
                 If it is not the case, the program execution must stop with an error.
             */
             void assert(eOperandType opType, std::string& value) const {
-                std::stack<IOperand*> temp = stack;
-                IOperand* topValue = temp.top();
-                const std::string strValue = topValue->toString();
+                assert(parseValue(opType, value));
+            }
+
+            void assert(const Value& expected) const {
+                if (stack.empty()) {
+                    throw EmptyStack();
+                }
 
-                if (!(value == strValue) && !(opType == topValue->getType())) {
+                if (!(stack.top() == expected)) {
                     throw AssertError();
-                } 
+                }
             }
 
             /*
@@ -109,180 +83,58 @@
                 If the number of values on the stack is strictly inferior to 2, the program execution must stop with an error.
             */
             void add() {
-                // Check if there's enough values in stack
-                if (!checkStackSize()) {
-                    throw LessThanTwoValues();
-                }
-
-                // Get the top two elements
-                IOperand* operand1 = stack.top();
-                stack.pop();
-                IOperand* operand2 = stack.top();
-                stack.pop();
-
-                IOperand* result = nullptr;
-
-                try {
-                    if (isSamePrecision(operand1, operand2)) {
-                        result = *operand1 + *operand2;
-                    } else {
-                        result = handlePrecisionAndConvert(operand1, operand2, addOperands);
-                    }
-                } catch (const std::overflow_error &ex) {
-                    delete operand1;
-                    delete operand2;
-                    throw Overflow();
-                }
-
-                stack.push(result);
-                delete operand1;
-                delete operand2;
+                applyOperation(OpAdd);
             }
 
             /* Unstacks the first two values on the stack, subtracts them, then stacks the result */
             void sub() {
-                if (!checkStackSize()) {
-                    throw LessThanTwoValues();
-                }
-
-                // Get the top two elements
-                IOperand* operand1 = stack.top();
-                stack.pop();
-                IOperand* operand2 = stack.top();
-                stack.pop();
-
-                IOperand* result = nullptr;
-
-                try {
-                    if (isSamePrecision(operand1, operand2)) {
-                        result = *operand1 - *operand2;
-                    } else {
-                        result = handlePrecisionAndConvert(operand1, operand2, subOperands);
-                    }
-                } catch (const std::overflow_error &ex) {
-                    delete operand1;
-                    delete operand2;
-                    throw Overflow();
-                }
-
-                stack.push(result);
-                delete operand1;
-                delete operand2;
+                applyOperation(OpSub);
             }
 
             void mul() {
-                if (!checkStackSize()) {
-                    throw LessThanTwoValues();
-                }
-
-                // Get the top two elements
-                IOperand* operand1 = stack.top();
-                stack.pop();
-                IOperand* operand2 = stack.top();
-                stack.pop();
-
-                IOperand* result = nullptr;
-
-                try {
-                    if (operand1->toString() == "0" || operand2->toString() == "0") {
-                        result = createHigherPrecisionZero(operand1, operand2);
-                    } else if (isSamePrecision(operand1, operand2)) {
-                        result = *operand1 * *operand2;
-                    } else {
-                        result = handlePrecisionAndConvert(operand1, operand2, mulOperands);
-                    }
-                } catch (const std::overflow_error &ex) {
-                    delete operand1;
-                    delete operand2;
-                    throw Overflow();
-                }
-
-                stack.push(result);
-                delete operand1;
-                delete operand2;
+                applyOperation(OpMul);
             };
 
+            // Division and modulo by zero raise DivisionByZero
             void div() {
-                if (!checkStackSize()) {
-                    throw LessThanTwoValues();
-                }
-
-                // Get the top two elements
-                IOperand* operand1 = stack.top();
-                stack.pop();
-                IOperand* operand2 = stack.top();
-                stack.pop();
-
-                if (operand2->toString() == "0" || operand1->toString() == "0") {
-                    delete operand1;
-                    delete operand2;
-                    throw DivisionByZero();
-                }
-
-                IOperand* result = nullptr;
-
-                try {
-                    if (operand1->toString() == "0") {
-                        result = createHigherPrecisionZero(operand1, operand2);
-                    } else if (isSamePrecision(operand1, operand2)) {
-                        result = *operand1 / *operand2;
-                    } else {
-                        result = handlePrecisionAndConvert(operand1, operand2, divOperands);
-                    }
-                } catch (const std::overflow_error &ex) {
-                    delete operand1;
-                    delete operand2;
-                    throw Overflow();
-                }
-
-                stack.push(result);
-                delete operand1;
-                delete operand2;
+                applyOperation(OpDiv);
             };
 
             void mod() {
-                if (!checkStackSize()) {
-                    throw LessThanTwoValues();
-                }
+                applyOperation(OpMod);
+            }
 
-                // Get the top two elements
-                IOperand* operand1 = stack.top();
-                stack.pop();
-                IOperand* operand2 = stack.top();
-                stack.pop();
+            // push of the value followed by the operation, the value only goes on the stack if the operation fails
+            void pushOperation(const Value& value, eArithOp op);
 
-                if (operand2->toString() == "0") {
-                    delete operand1;
-                    delete operand2;
-                    throw DivisionByZero();
-                }
-
-                IOperand* result = nullptr;
-
-                try {
-                    if (isSamePrecision(operand1, operand2)) {
-                        result = *operand1 % *operand2;
-                    } else {
-                        result = handlePrecisionAndConvert(operand1, operand2, modOperands);
-                    }
-                } catch (const std::overflow_error &ex) {
-                    delete operand1;
-                    delete operand2;
-                    throw Overflow();
-                }
+            /*
+                Vector instructions (see VectorOperations.cpp):
+                sum replaces the whole stack by the sum of its values, addTop(n) the n values on top.
+                mulPairs(n) multiplies the n values on top with the n values below them, one by one,
+                and leaves the n products.
+            */
+            void sum();
+            void addTop(size_t count);
+            void mulPairs(size_t count);
 
-                stack.push(result);
-                delete operand1;
-                delete operand2;
-            }
+            /*
+                Control flow (see ControlFlow.cpp): dup pushes a copy of the value on top, swap exchanges
+                the two values on top. branch pops the two values on top and tells whether a conditional
+                jump is taken: like sub, the top value is the left operand, jlt jumps if top < second.
+                call saves the instruction to return to, ret gives it back.
+            */
+            void dup();
+            void swap();
+            bool branch(uint8_t opcode);
+            void call(size_t returnTo);
+            size_t ret();
 
             void print() const {
                 if (stack.empty()) {
                     throw EmptyStack();
                 }
 
-                IOperand* operand = stack.top();
-                int value = std::stoi(operand->toString());
+                int value = stack.top().to<int>();
 
                 if (value <= std::numeric_limits<int8_t>::min() && value >= std::numeric_limits<int8_t>::max()) {
                     std::cerr << "Value out of range for 8-bit integer" << std::endl;
@@ -290,34 +142,113 @@
                 }
 
                 int8_t int8Value = static_cast<int8_t>(value);
-                std::cout << static_cast<char>(int8Value) << std::endl;
+                output->put(static_cast<char>(int8Value));
+                output->put('\n');
             }
 
+            // Ends the program: run() returns Exited, the host process keeps running
             void exitProgram() const {
-                std::cout << "Exiting program..." << std::endl;
-                exit(0);
+                output->write("Exiting program...\n", 19);
+                output->flush();
+            }
+
+            /*
+                Runs count compiled instructions and returns Exited if an exit instruction was reached,
+                Completed if the code ran to its end. Errors are thrown as ProgramError with the line
+                of the instruction that raised them.
+            */
+            eRunStatus run(const Instruction* code, size_t count);
+
+            /*
+                Same from code[pc]: jump targets are indices in code, so a program is never resumed from
+                code + pc. The run completes as soon as the next instruction is at count or beyond, by a
+                jump or not, and pc is left there: running a program in parts [0, a), [a, b)... with the
+                pc of the previous part gives the same result as a single run.
+            */
+            eRunStatus run(const Instruction* code, size_t count, size_t& pc);
+
+            /*
+                Runs the register form of a program (see RegisterProgram.hpp), with the same output,
+                errors and final stack as the stack program it was translated from. A block that fails
+                is run again by the stack interpreter, which raises the error and runs the rest.
+                Pairs and profiles are only recorded by the stack interpreter.
+            */
+            eRunStatus run(const RegisterProgram& program);
+
+            /*
+                Binary snapshot of the state about to run code[pc]: the stack as native values, the
+                return addresses of the calls and the position of the output (see Snapshot.hpp). program identifies the code the pc refers to,
+                instructionChecksum(code, count) for a whole program, and is computed by the caller so
+                that it can be reused. restoreState checks that the snapshot was taken on the same
+                program, then restores it with a single copy of the stack and returns the pc to resume
+                from: run(code, count, pc). Nothing changes if it throws.
+            */
+            std::string saveState(uint64_t program, size_t pc) const;
+            size_t      restoreState(uint64_t program, size_t count, const char* data, size_t size);
+
+            // Empties the stack and the calls so the VM can run another program
+            void reset() {
+                stack.clear();
+                calls.clear();
             }
 
+            // Calls not returned from yet
+            size_t          callDepth() const { return calls.size(); }
+
+            // Values are read in place, index 0 is the bottom of the stack
+            const ValueStack& getStack() const { return stack; }
+
+            // Sink written by dump, print and exit, a buffered standard output by default
+            void            setOutput(OutputSink& sink) { output = &sink; }
+            void            resetOutput() { output = &standardOutput; }
+            OutputSink&     getOutput() { return *output; }
+
+            // Records every executed opcode pair in counter, nullptr stops the recording
+            void            setPairCounter(PairCounter* counter) { pairCounter = counter; }
+
+            // Records time, allocations, line hits and stack depth of every instruction, nullptr stops it
+            void            setProfiler(Profiler* attached) { profiler = attached; }
+
+            // Kernels of the vector instructions, the best ones of the CPU by default
+            void            setVectorKernels(const VectorKernels& kernels) { vector = &kernels; }
+
         private:
-            // Must contain ONLY pointers on the abstract type IOperand
-            std::stack<IOperand*> stack;
-            OperandFactory factory;
-
-            // Functions for type of operations
-            using OperationFunc = std::function<IOperand*(const IOperand&, const IOperand&)>;
-            static IOperand* addOperands(const IOperand& op1, const IOperand& op2);
-            static IOperand* subOperands(const IOperand& op1, const IOperand& op2);
-            static IOperand* mulOperands(const IOperand& op1, const IOperand& op2);
-            static IOperand* divOperands(const IOperand& op1, const IOperand& op2);
-            static IOperand* modOperands(const IOperand& op1, const IOperand& op2);
-
-            // Precision related functions
-            IOperand*   getLowerPrecision(IOperand* type1, IOperand* type2) const;
-            IOperand*   handlePrecisionAndConvert(IOperand* operand1, IOperand* operand2, OperationFunc operation);
-            IOperand*   createHigherPrecisionZero(IOperand* operand1, IOperand* operand2);
-            bool        isSamePrecision(IOperand* type1, IOperand* type2) const;
+            // Deep enough for any sane recursion, small enough to fail long before the memory runs out
+            static const size_t MAX_CALL_DEPTH = 1 << 20;
+
+            // Values are stored inline, no operand object is allocated per value
+            ValueStack stack;
+            FdSink          standardOutput{STDOUT_FILENO};
+            OutputSink*     output = &standardOutput;
+            PairCounter*    pairCounter = nullptr;
+            Profiler*       profiler = nullptr;
+
+            // Native copies of a stack region for the vector kernels, they only grow
+            struct VectorScratch {
+                std::vector<int32_t>    ints;
+                std::vector<double>     lhs;
+                std::vector<double>     rhs;
+                std::vector<double>     result;
+                std::vector<Value>      values;
+            };
+
+            const VectorKernels*    vector = &VectorKernels::best();
+            VectorScratch           scratch;
+            std::vector<uint32_t>   calls;      // return addresses of the calls in progress
+            std::vector<Value>      registers;  // register file of run(const RegisterProgram&)
+
+            // Dispatch loop, observer.step() runs before every instruction (see Interpreter.cpp)
+            template <typename Observer>
+            eRunStatus  execute(const Instruction* code, size_t count, size_t& pc, Observer& observer);
+
+            // Replaces the two values on top of the stack by the result of the operation
+            void        applyOperation(eArithOp op);
 
             // Helper
             bool        checkStackSize();
+
+            Value       chainSum(size_t first, size_t count) const;
+            Value       vectorSum(size_t first, size_t count);
+            void        vectorProducts(size_t first, size_t count);
     };
 #endif
\ No newline at end of file
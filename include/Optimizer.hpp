@@ -0,0 +1,48 @@
+#ifndef OPTIMIZER_HPP
+#define OPTIMIZER_HPP
+
+    #include "./Program.hpp"
+    #include "./Kernels.hpp"
+    #include <vector>
+
+    /*
+        Peephole pass over a compiled program, run once before the program is executed or written
+        to a .avmc file. The optimized program prints the same output and raises the same errors,
+        on the same lines, as the original one:
+            - push a; push b; op    is folded to a single push of (b op a), computed with the same
+                                    kernels as the VM. An operation that would throw is left as it
+                                    is, so the error is still raised at run time on its own line
+            - push v; pop           is removed
+            - push v; assert v      is reduced to the push, the assert can not fail
+            - push v; op            becomes one fused instruction (PushAdd...PushMod)
+            - assert v; pop         becomes AssertPop
+            - dump; pop             becomes DumpPop
+        The fused pairs are the most frequent ones reported by PairCounter (--pairs) on our programs.
+        An instruction that a jump goes to is flagged JUMP_TARGET and never merged into the one before
+        it, since it does not always run after it. Jumps are then set to the new index of their target.
+    */
+    class Optimizer {
+        public:
+            struct Stats {
+                size_t folded = 0;          // operations computed at compile time
+                size_t removed = 0;         // push/pop pairs dropped
+                size_t fused = 0;           // pairs merged in one instruction
+                size_t resolved = 0;        // asserts proven at compile time
+            };
+
+            Program         optimize(const Program& program);
+
+            const Stats&    stats() const { return _stats; }
+
+        private:
+            std::vector<Instruction>    code;
+            std::vector<uint32_t>       position;       // index in code of each instruction of the program
+            bool                        carryTarget = false;
+            Stats                       _stats;
+
+            // Applies every rewrite that the instruction just appended to code makes possible
+            void            reduce();
+            bool            fold(eArithOp op);
+            void            fuse(eInstructionType opcode, uint32_t line);
+    };
+#endif
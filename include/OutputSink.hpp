@@ -0,0 +1,116 @@
+#ifndef OUTPUT_SINK_HPP
+#define OUTPUT_SINK_HPP
+
+    #include <stddef.h>
+    #include <string.h>
+    #include <string>
+    #include <vector>
+
+    /*
+        Buffered destination of everything the VM prints (dump, print, exit).
+        Writes are copied in a large buffer that is only handed to the backend when it is full
+        or when flush() is called: the VM flushes at exit, on error and when a run ends.
+    */
+    class OutputSink {
+        public:
+            static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+            explicit OutputSink(size_t capacity = DEFAULT_CAPACITY) : buffer(capacity > 0 ? capacity : 1) {}
+            virtual ~OutputSink() {}
+
+            OutputSink(const OutputSink&) = delete;
+            OutputSink& operator=(const OutputSink&) = delete;
+
+            void write(const char* data, size_t size) {
+                if (size > buffer.size() - used) {
+                    flush();
+
+                    // bigger than the whole buffer, no point in copying it
+                    if (size >= buffer.size()) {
+                        commit(data, size);
+                        committed += size;
+                        return;
+                    }
+                }
+                memcpy(buffer.data() + used, data, size);
+                used += size;
+            }
+
+            void write(const std::string& text) {
+                write(text.data(), text.size());
+            }
+
+            void put(char c) {
+                if (used == buffer.size()) {
+                    flush();
+                }
+                buffer[used++] = c;
+            }
+
+            void flush() {
+                if (used > 0) {
+                    commit(buffer.data(), used);
+                    committed += used;
+                    used = 0;
+                }
+            }
+
+            // Bytes written so far, counted from the position set last (0 at first)
+            size_t position() const {
+                return committed + used;
+            }
+
+            // Used by a restored snapshot, the output goes on from where the program was
+            void setPosition(size_t position) {
+                flush();
+                committed = position;
+            }
+
+        protected:
+            // Hands a full block to the backend
+            virtual void commit(const char* data, size_t size) = 0;
+
+        private:
+            std::vector<char>   buffer;
+            size_t              used = 0;
+            size_t              committed = 0;
+    };
+
+    // Writes to a file descriptor, e.g. STDOUT_FILENO or a file opened by the caller
+    class FdSink : public OutputSink {
+        public:
+            explicit FdSink(int fd, size_t capacity = DEFAULT_CAPACITY) : OutputSink(capacity), fd(fd) {}
+            ~FdSink() { flush(); }
+
+        protected:
+            void commit(const char* data, size_t size) override;
+
+        private:
+            int fd;
+    };
+
+    // Keeps the output in memory, for callers that embed the VM and want to read what it printed
+    class MemorySink : public OutputSink {
+        public:
+            explicit MemorySink(size_t capacity = DEFAULT_CAPACITY) : OutputSink(capacity) {}
+
+            const std::string& str() {
+                flush();
+                return text;
+            }
+
+            // Drops the text kept so far, the position goes on
+            void clear() {
+                flush();
+                text.clear();
+            }
+
+        protected:
+            void commit(const char* data, size_t size) override {
+                text.append(data, size);
+            }
+
+        private:
+            std::string text;
+    };
+#endif
@@ -0,0 +1,40 @@
+#ifndef PAIR_COUNTER_HPP
+#define PAIR_COUNTER_HPP
+
+    #include "./Program.hpp"
+    #include <stdint.h>
+    #include <vector>
+
+    /*
+        Counts how often each opcode is executed right after each other one.
+        The most frequent pairs are the candidates for the fused instructions of the Optimizer.
+        A VM only records into it when one is attached (MyAbstractVM::setPairCounter), the loop
+        without a counter is compiled separately and does not check for it.
+    */
+    class PairCounter {
+        public:
+            struct Pair {
+                uint8_t     first;
+                uint8_t     second;
+                uint64_t    count;
+            };
+
+            void record(uint8_t opcode) {
+                if (last < INSTRUCTION_TYPES) {
+                    counts[last][opcode]++;
+                }
+                last = opcode;
+            }
+
+            uint64_t            count(uint8_t first, uint8_t second) const { return counts[first][second]; }
+
+            // The n most frequent pairs, most frequent first
+            std::vector<Pair>   top(size_t n) const;
+
+            void                clear();
+
+        private:
+            uint64_t    counts[INSTRUCTION_TYPES][INSTRUCTION_TYPES] = {};
+            size_t      last = INSTRUCTION_TYPES;   // nothing executed yet
+    };
+#endif
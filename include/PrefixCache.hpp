@@ -0,0 +1,83 @@
+#ifndef PREFIX_CACHE_HPP
+#define PREFIX_CACHE_HPP
+
+    #include "./Program.hpp"
+    #include <stdint.h>
+    #include <list>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+
+    /*
+        States of the VM after the prefixes of the programs it ran, so that a program that starts like
+        an earlier one resumes where their instructions part instead of replaying them from line 1.
+        Checkpoints sit every interval instructions: the key of one is the hash of the compiled
+        instructions before it, extended checkpoint by checkpoint as the program is walked (wordHash),
+        and it keeps a snapshot of the stack (MyAbstractVM::saveState) with the output of the prefix.
+        A run looks up all of its checkpoints but only stores a few of them (see VmInstance.cpp).
+
+        Only runs that start from an empty state use the cache (see VmInstance::setPrefixCache), and a
+        checkpoint is only stored once the prefix before it ran without error or exit.
+        Least recently used checkpoints are dropped to stay under the memory budget. The cache is
+        thread safe: one instance can serve every worker of a batch or a server.
+    */
+    class PrefixCache {
+        public:
+            static const size_t DEFAULT_INTERVAL = 256;
+
+            struct Checkpoint {
+                std::string snapshot;
+                std::string output;     // printed by the prefix
+            };
+
+            struct Stats {
+                uint64_t    hits = 0;           // runs resumed from a checkpoint
+                uint64_t    misses = 0;         // runs with checkpoints that found none of them
+                uint64_t    stores = 0;
+                uint64_t    evictions = 0;
+                uint64_t    skipped = 0;        // instructions not run thanks to the hits
+                size_t      entries = 0;
+                size_t      bytes = 0;
+            };
+
+            // budget in bytes, snapshots, outputs and bookkeeping included
+            explicit PrefixCache(size_t budget, size_t interval = DEFAULT_INTERVAL);
+
+            PrefixCache(const PrefixCache&) = delete;
+            PrefixCache& operator=(const PrefixCache&) = delete;
+
+            // Keys of the checkpoints of code: hashes[i] for the prefix that ends at (i + 1) * interval
+            void        prefixHashes(const Instruction* code, size_t count, std::vector<uint64_t>& hashes) const;
+
+            /*
+                Deepest checkpoint of a program among its prefix hashes, and its index in hashes.
+                nullptr on a miss. The checkpoint stays valid after its eviction.
+            */
+            std::shared_ptr<const Checkpoint>   find(const std::vector<uint64_t>& hashes, size_t& index);
+
+            // contains() first saves building a snapshot that another program already stored
+            bool        contains(uint64_t hash);
+            void        store(uint64_t hash, std::string snapshot, std::string output);
+
+            size_t      interval() const { return _interval; }
+            size_t      budget() const { return _budget; }
+            Stats       stats();
+
+        private:
+            struct Entry {
+                uint64_t                            hash;
+                size_t                              bytes;
+                std::shared_ptr<const Checkpoint>   checkpoint;
+            };
+
+            size_t                                                      _budget;
+            size_t                                                      _interval;
+
+            std::mutex                                                  lock;
+            std::list<Entry>                                            recent;     // most recently used first
+            std::unordered_map<uint64_t, std::list<Entry>::iterator>    entries;
+            Stats                                                       _stats;
+    };
+#endif
@@ -0,0 +1,85 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+    #include "./Program.hpp"
+    #include "./ValueStack.hpp"
+    #include <stdint.h>
+    #include <chrono>
+    #include <ostream>
+    #include <vector>
+
+    /*
+        Instrumentation of the dispatch loop for --profile.
+        The loop calls step() before every instruction and finish() when it stops; the time and the
+        growths of the value stack between two calls are charged to the instruction that ran in between.
+        Values are stored inline in the stack, so its growths are the only allocations of a run.
+        The clock is read once per instruction, so the numbers include that cost.
+
+        MyAbstractVM only instantiates the instrumented loop while a profiler is attached,
+        a run without one executes a loop where none of this exists.
+    */
+    class Profiler {
+        public:
+            struct OpcodeStats {
+                uint64_t    count = 0;
+                uint64_t    nanoseconds = 0;
+                uint64_t    stackGrowths = 0;       // "stack growths" in the table, "stack_growths" in JSON
+
+                double      averageNanoseconds() const { return count ? double(nanoseconds) / count : 0; }
+            };
+
+            void step(const Instruction& instruction, const ValueStack& stack) {
+                Clock::time_point now = Clock::now();
+                uint64_t growths = stack.growths();
+
+                close(now, growths, stack);
+
+                current = instruction.opcode;
+                started = now;
+                startGrowths = growths;
+                opcodes[current].count++;
+
+                if (instruction.line >= lines.size()) {
+                    lines.resize(instruction.line + 1);
+                }
+                lines[instruction.line]++;
+            }
+
+            void finish(const ValueStack& stack) {
+                close(Clock::now(), stack.growths(), stack);
+                current = INSTRUCTION_TYPES;
+            }
+
+            const OpcodeStats&  opcode(uint8_t opcode) const { return opcodes[opcode]; }
+            uint64_t            lineHits(uint32_t line) const { return line < lines.size() ? lines[line] : 0; }
+            size_t              peakStackDepth() const { return peakDepth; }
+
+            // Table of the opcodes that ran and of the hottest lines, for a terminal
+            void                writeTable(std::ostream& out, size_t hottestLines = 10) const;
+
+            // Every counter, lines are only listed when they were hit
+            void                writeJson(std::ostream& out) const;
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            OpcodeStats             opcodes[INSTRUCTION_TYPES];
+            std::vector<uint64_t>   lines;                  // hits, indexed by source line
+            size_t                  peakDepth = 0;
+
+            size_t                  current = INSTRUCTION_TYPES;    // instruction running, none at first
+            Clock::time_point       started;
+            uint64_t                startGrowths = 0;
+
+            // Charges the instruction that just ended
+            void close(Clock::time_point now, uint64_t growths, const ValueStack& stack) {
+                if (current < INSTRUCTION_TYPES) {
+                    opcodes[current].nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(now - started).count();
+                    opcodes[current].stackGrowths += growths - startGrowths;
+                }
+                if (stack.size() > peakDepth) {
+                    peakDepth = stack.size();
+                }
+            }
+    };
+#endif
@@ -0,0 +1,194 @@
+#ifndef PROGRAM_HPP
+#define PROGRAM_HPP
+
+    #include "./Value.hpp"
+    #include <stdint.h>
+    #include <string.h>
+    #include <string>
+    #include <string_view>
+    #include <vector>
+
+    // Instructions that we can use to create the different variables
+    enum eInstructionType { Push, Pop, Dump, Assert, Add, Sub, Mul, Div, Mod, Print, Exit, Nil,
+        // Vector instructions over a region of the stack: sum, addn T(n), mulp T(n)
+        Sum, AddN, MulPairs,
+        // Control flow, the target of a jump is the absolute index of an instruction: jmp label,
+        // jeq/jne/jlt/jle/jgt/jge label, call label, ret, and the stack helpers dup and swap
+        Jmp, Jeq, Jne, Jlt, Jle, Jgt, Jge, Call, Ret, Dup, Swap,
+        // Fused instructions, only emitted by the Optimizer
+        PushAdd, PushSub, PushMul, PushDiv, PushMod, AssertPop, DumpPop };
+
+    const size_t INSTRUCTION_TYPES = DumpPop + 1;
+
+    // Mnemonic of an opcode, fused instructions are shown as their two parts
+    inline const char* instructionName(uint8_t opcode) {
+        static const char* const names[INSTRUCTION_TYPES] = {
+            "push", "pop", "dump", "assert", "add", "sub", "mul", "div", "mod", "print", "exit", "nil",
+            "sum", "addn", "mulp",
+            "jmp", "jeq", "jne", "jlt", "jle", "jgt", "jge", "call", "ret", "dup", "swap",
+            "push+add", "push+sub", "push+mul", "push+div", "push+mod", "assert+pop", "dump+pop",
+        };
+        return opcode < INSTRUCTION_TYPES ? names[opcode] : "?";
+    }
+
+    // Add...Mod and PushAdd...PushMod follow the order of eArithOp
+    inline bool isArithmetic(uint8_t opcode) { return opcode >= Add && opcode <= Mod; }
+    inline eArithOp arithOp(uint8_t opcode) { return static_cast<eArithOp>(opcode - Add); }
+
+    // Instructions with a target: Jmp, the conditional jumps and Call
+    inline bool isJump(uint8_t opcode) { return opcode >= Jmp && opcode <= Call; }
+
+    // Whether the conditional jump opcode is taken for order, the compareValues of its two operands
+    inline bool jumpTaken(uint8_t opcode, int order) {
+        switch (opcode) {
+            case Jeq: return order == 0;
+            case Jne: return order != 0;
+            case Jlt: return order < 0;
+            case Jle: return order <= 0;
+            case Jgt: return order > 0;
+            default:  return order >= 0;
+        }
+    }
+
+    // Set by the Optimizer on the instructions that a jump goes to: nothing is merged across them
+    const uint16_t JUMP_TARGET = 1;
+
+    /*
+        One compiled instruction. Every instruction has the same size so a program is a flat array:
+        the opcode, the type of the operand and its value already decoded (push and assert only),
+        and the source line used to report errors. Jumps keep the index of their target in the
+        immediate.
+    */
+    struct Instruction {
+        uint8_t     opcode;
+        uint8_t     type;
+        uint16_t    flags;
+        uint32_t    line;
+        Scalar      immediate;
+
+        Value operand() const {
+            Value value;
+            value.type = static_cast<eOperandType>(type);
+            value.raw = immediate;
+            return value;
+        }
+
+        uint32_t target() const { return static_cast<uint32_t>(immediate.i32); }
+        void     setTarget(uint32_t pc) { immediate.i32 = static_cast<int32_t>(pc); }
+    };
+
+    static_assert(sizeof(Instruction) == 16, "Instruction must stay a fixed 16 bytes record");
+
+    // FNV-1a over raw bytes, hash chains several blocks: checksum of the .avmc files
+    inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /*
+        Hash of the same family eight bytes at a time, several times faster than fnv1a on long blocks:
+        for the blocks hashed on a hot path, snapshots of a deep stack and prefixes of long programs
+    */
+    inline uint64_t wordHash(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+
+            memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 32;
+        }
+        return fnv1a(bytes + i, size - i, hash);
+    }
+
+    // Identity of a compiled program: equal for the same instruction records, however they were loaded
+    inline uint64_t instructionChecksum(const Instruction* code, size_t count) {
+        return fnv1a(code, count * sizeof(Instruction));
+    }
+
+    // A label written in the source ("loop:") or named by a jump, pc is the instruction it stands for
+    struct LabelMark {
+        std::string     name;
+        uint32_t        pc;
+        uint32_t        line;
+    };
+
+    /*
+        A compiled program, ready to be run by MyAbstractVM::run once Compiler::link has set the
+        target of its jumps. Until then the labels and the jumps are kept by name.
+    */
+    class Program {
+        public:
+            void append(const Instruction& instruction) {
+                if (instruction.opcode == Exit && !hasExit()) {
+                    _firstExit = code.size();
+                }
+                code.push_back(instruction);
+            }
+
+            // The label stands for the next instruction appended
+            void defineLabel(std::string_view name, uint32_t line) {
+                _labels.push_back({std::string(name), static_cast<uint32_t>(code.size()), line});
+            }
+
+            void appendJump(const Instruction& instruction, std::string_view label) {
+                _jumps.push_back({std::string(label), static_cast<uint32_t>(code.size()), instruction.line});
+                append(instruction);
+            }
+
+            // Keeps the first count instructions, and the labels and jumps of them
+            void truncate(size_t count) {
+                code.resize(count);
+                if (_firstExit >= count) {
+                    _firstExit = NO_EXIT;
+                }
+                while (!_labels.empty() && _labels.back().pc >= count) {
+                    _labels.pop_back();
+                }
+                while (!_jumps.empty() && _jumps.back().pc >= count) {
+                    _jumps.pop_back();
+                }
+            }
+
+            void reserve(size_t count) {
+                code.reserve(count);
+            }
+
+            void clear() {
+                code.clear();
+                _labels.clear();
+                _jumps.clear();
+                _firstExit = NO_EXIT;
+            }
+
+            const Instruction*  data() const { return code.data(); }
+            Instruction*        data() { return code.data(); }
+            size_t              size() const { return code.size(); }
+            bool                hasExit() const { return _firstExit != NO_EXIT; }
+            size_t              firstExit() const { return _firstExit; }
+
+            // In source order. Jumps only stay here until link() finds their label
+            std::vector<LabelMark>&         labels() { return _labels; }
+            std::vector<LabelMark>&         jumps() { return _jumps; }
+            const std::vector<LabelMark>&   labels() const { return _labels; }
+            const std::vector<LabelMark>&   jumps() const { return _jumps; }
+
+            // The instructions before the first jump without a target yet: what can already run
+            size_t              linkedSize() const { return _jumps.empty() ? code.size() : _jumps.front().pc; }
+
+        private:
+            static const size_t NO_EXIT = SIZE_MAX;
+
+            std::vector<Instruction> code;
+            std::vector<LabelMark>   _labels;
+            std::vector<LabelMark>   _jumps;
+            size_t                   _firstExit = NO_EXIT;
+    };
+#endif
@@ -0,0 +1,85 @@
+#ifndef REGISTER_PROGRAM_HPP
+#define REGISTER_PROGRAM_HPP
+
+    #include "./Program.hpp"
+    #include <stdint.h>
+    #include <vector>
+
+    /*
+        Register form of a compiled program, built by RegisterTranslator and run by
+        MyAbstractVM::run(const RegisterProgram&).
+
+        The stack program is cut in blocks of straight-line stack code (push, pop, assert, the
+        arithmetic, dup, swap). Inside a block the values live in virtual registers: every result
+        gets a register of its own, the values that were on the stack when the block started are
+        read in place (Peek), and the stack is only written once, when the block ends (Drop, then
+        one Store or Push per value left). A block never writes the stack or prints before it ends, so if
+        anything in it fails, the block is run again by the stack interpreter from its first
+        instruction: the error, its line and the stack are exactly those of the stack program.
+
+        The other instructions (dump, print, the vector ones, jumps, call, ret, exit) run on the
+        stack between the blocks, like in the stack interpreter. A conditional jump ends its block
+        and compares two registers, its operands never go back to the stack.
+    */
+    enum eRegisterOp : uint8_t {
+        RegEnter,       // start of a block: the stack must hold count values, pc is where to rerun it from
+        RegLoad,        // dst = immediate
+        RegPeek,        // dst = value count places below the top of the stack at the start of the block
+        RegArith,       // dst = lhs op rhs, lhs was the top of the stack
+        RegArithImm,    // dst = immediate op rhs, a push followed by an operation
+        RegAssert,      // lhs must be equal to immediate
+        RegDrop,        // pops count values
+        RegStore,       // pushes lhs
+        RegPush,        // pushes immediate, a constant of the block that no instruction read
+        RegBranch,      // jumps to target if the conditional jump op holds for lhs and rhs
+        // Stack instructions, count is the operand of addn and mulp, target the index of a jump
+        RegDump, RegDumpPop, RegPrint, RegSum, RegAddN, RegMulPairs, RegJmp, RegCall, RegRet, RegExit,
+        // After the last instruction
+        RegEnd };
+
+    const size_t REGISTER_OPS = RegEnd + 1;
+
+    /*
+        One register instruction. pc is the index in the stack program to rerun from if it fails:
+        the start of the block for the instructions of a block, the instruction itself for the others.
+    */
+    struct RegisterInstruction {
+        uint8_t     opcode;
+        uint8_t     op;             // eArithOp of RegArith/RegArithImm, stack opcode of RegBranch
+        uint16_t    dst;
+        uint16_t    lhs;
+        uint16_t    rhs;
+        uint32_t    pc;
+        uint32_t    count;          // values needed, depth, values dropped, or the target of a jump
+        Value       immediate;
+    };
+
+    static_assert(sizeof(RegisterInstruction) == 32, "RegisterInstruction must stay a fixed 32 bytes record");
+
+    class RegisterProgram {
+        public:
+            static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+            const RegisterInstruction*  data() const { return code.data(); }
+            size_t                      size() const { return code.size(); }
+
+            // Registers used by the largest block: the size of the register file
+            size_t                      registerCount() const { return registers; }
+
+            // The stack program it was translated from, run from the pc of an instruction that fails
+            const Instruction*          stackData() const { return stack; }
+            size_t                      stackSize() const { return stackCount; }
+
+            // Index of the register instruction to continue from at a stack pc that a jump or a ret goes to
+            uint32_t                    entry(size_t pc) const { return pc < entries.size() ? entries[pc] : NO_ENTRY; }
+
+        private:
+            friend class RegisterTranslator;
+
+            std::vector<RegisterInstruction>    code;
+            const Instruction*                  stack = nullptr;
+            size_t                              stackCount = 0;
+            std::vector<uint32_t>               entries;
+            size_t                              registers = 0;
+    };
+#endif
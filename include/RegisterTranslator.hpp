@@ -0,0 +1,66 @@
+#ifndef REGISTER_TRANSLATOR_HPP
+#define REGISTER_TRANSLATOR_HPP
+
+    #include "./RegisterProgram.hpp"
+    #include <vector>
+
+    /*
+        Translates a linked stack program (optimized or not) into its register form, see
+        RegisterProgram.hpp. The stack of a block is simulated while it is translated: each slot
+        is a register, a value still on the stack at the start of the block, or a pushed constant.
+        So dup and swap only move slots around, pop of a value never read costs nothing, a constant
+        is only loaded in a register when an instruction can not take it as its immediate, and an
+        operation reads its operands from registers. Blocks also end at every jump target and every
+        return address, and after MAX_REGISTERS slots to keep the register file in the L1 cache.
+    */
+    class RegisterTranslator {
+        public:
+            static const size_t MAX_REGISTERS = 256;
+
+            struct Stats {
+                size_t blocks = 0;          // blocks of register code
+                size_t peeks = 0;           // values read from the stack by a block
+                size_t stores = 0;          // values written back to the stack when a block ends
+                size_t elided = 0;          // stack instructions that left no register instruction
+            };
+
+            // The register form refers to the instructions of program, which must outlive it
+            RegisterProgram translate(const Program& program);
+
+            const Stats&    stats() const { return _stats; }
+
+        private:
+            static constexpr uint16_t NO_REGISTER = UINT16_MAX;
+
+            enum eSlot { InRegister, OnStack, Constant };
+
+            // A value of the simulated stack: a register, a depth on the stack at the start of the block, or the pc of the instruction that pushed it
+            struct Slot {
+                eSlot       kind;
+                uint32_t    index;
+            };
+
+            RegisterProgram         result;
+            const Instruction*      stack = nullptr;    // the program being translated
+            std::vector<Slot>       slots;          // values pushed by the block, top last
+            std::vector<uint16_t>   peeked;         // register already read from each depth
+            size_t                  enter = 0;      // index of the RegEnter of the open block
+            uint32_t                start = 0;      // stack pc of its first instruction
+            bool                    open = false;
+            uint32_t                consumed = 0;   // values of the stack below the slots taken by the block
+            uint16_t                next = 0;       // first free register
+            Stats                   _stats;
+
+            void            openBlock(uint32_t pc);
+            void            closeBlock();
+            void            translateBlock(const Instruction& instruction, uint32_t pc);
+            void            translateStack(const Instruction& instruction, uint32_t pc);
+
+            Slot            take();
+            void            push(Slot slot) { slots.push_back(slot); }
+            void            push(eSlot kind, uint32_t index) { slots.emplace_back() = Slot{kind, index}; }
+            uint16_t        reg(Slot slot);
+            uint16_t        allocate() { return next++; }
+            RegisterInstruction&    emit(uint8_t opcode, uint32_t pc);
+    };
+#endif
@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+    #include <stdint.h>
+
+    // Bumped every time the layout of the snapshot or of the packed stack changes
+    const uint16_t AVMS_VERSION = 3;
+
+    /*
+        Header of a snapshot (.avms), written by MyAbstractVM::saveState. It is followed by
+        segmentCount SnapshotSegment records, then by the callCount return addresses of the calls in
+        progress (uint32_t, oldest first), then by the stackBytes bytes of the packed stack exactly
+        as ValueStack keeps them: native values in host byte order, so a snapshot is restored on the
+        same architecture, like a .avmc file is run.
+    */
+    struct SnapshotHeader {
+        char        magic[4];           // "AVMS"
+        uint16_t    version;
+        uint16_t    segmentSize;        // sizeof(SnapshotSegment) of the writer
+        uint32_t    segmentCount;
+        uint32_t    callCount;
+        uint64_t    program;            // identity of the code the pc refers to, see MyAbstractVM::saveState
+        uint64_t    pc;                 // next instruction to run
+        uint64_t    outputPosition;     // bytes printed by the program up to the pc
+        uint64_t    valueCount;
+        uint64_t    stackBytes;
+        uint64_t    checksum;           // wordHash of the header up to here, then of everything after it
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must stay 64 bytes");
+
+    // ValueStack::Segment with a fixed layout
+    struct SnapshotSegment {
+        uint8_t     type;
+        uint8_t     reserved[7];
+        uint64_t    first;
+        uint64_t    offset;
+    };
+
+    static_assert(sizeof(SnapshotSegment) == 24, "SnapshotSegment must stay 24 bytes");
+#endif
@@ -0,0 +1,52 @@
+#ifndef STREAM_RUNNER_HPP
+#define STREAM_RUNNER_HPP
+
+    #include "./Compiler.hpp"
+    #include "./Optimizer.hpp"
+    #include "./MyAbstractVm.hpp"
+    #include <string>
+
+    /*
+        Runs a source file in a single pass: the file is mapped, and its lines are compiled and run
+        in small batches while it is read, instead of scanning the whole file for exit first.
+
+        A program without exit must still fail with NoExitInstruction and print nothing, so the output
+        is held back until exit has been compiled:
+            - exit reached: the held output is written, then the rest runs with direct output
+            - error before exit: the rest of the file is only scanned for exit, the held output is
+              written and the error reported if there is one, otherwise NoExitInstruction is raised
+            - end of file without exit: the held output is dropped and NoExitInstruction is raised
+        The held output is kept in memory, programs that print a lot before their exit use as much.
+
+        Jumps need the code they go back to: from the first label or jump on, the batches are kept
+        instead of dropped, run as compiled (not optimized), and each run stops before the first jump
+        whose label is not compiled yet, to go on once it is. As in the whole file mode, a jump before
+        the first exit to a label after it makes the whole file the program: from its exit on, the
+        rest of the file is compiled before anything more runs, so that an invalid line there fails
+        the program without output, as in the whole file mode.
+    */
+    class StreamRunner {
+        public:
+            StreamRunner(Compiler& compiler, MyAbstractVM& vm) : compiler(compiler), vm(vm) {}
+
+            void runFile(const std::string& fileName);
+
+        private:
+            static const size_t BATCH_SIZE = 4096;
+
+            Compiler&           compiler;
+            MyAbstractVM&       vm;
+            Optimizer           optimizer;
+            MemorySink          held;
+            bool                exitSeen = false;
+            bool                toEnd = false;      // code after the exit is reachable
+            bool                exited = false;
+            size_t              pc = 0;             // next instruction once the batches are kept
+            size_t              ran = 0;            // instructions of the kept batches already handed to the VM
+
+            void                runBatch(Program& batch, bool last = false);
+            void                runCompiled(Program& batch, bool last);
+            void                releaseOutput();
+            static bool         isExitLine(const char* begin, const char* end);
+    };
+#endif
@@ -0,0 +1,281 @@
+#ifndef VALUE_HPP
+#define VALUE_HPP
+
+    #include <stdint.h>
+    #include <charconv>
+    #include <cmath>
+    #include <limits>
+    #include <string>
+    #include <string_view>
+    #include <system_error>
+    #include <type_traits>
+    #include "./Exceptions.hpp"
+
+    enum eOperandType { Int8, Int16, Int32, Float, Double };
+
+    // The five arithmetic instructions, used to pick the operation to apply on two values
+    enum eArithOp { OpAdd, OpSub, OpMul, OpDiv, OpMod };
+
+    // Raw storage shared by every operand type, the eOperandType stored next to it tells which member is active
+    union Scalar {
+        int8_t  i8;
+        int16_t i16;
+        int32_t i32;
+        float   f32;
+        double  f64;
+    };
+
+    // Maps an eOperandType to its native C++ type and to the matching member of Scalar
+    template <eOperandType Type> struct OperandTraits;
+
+    template <> struct OperandTraits<Int8> {
+        using type = int8_t;
+        static type  get(const Scalar& s) { return s.i8; }
+        static void  set(Scalar& s, type v) { s.i8 = v; }
+    };
+
+    template <> struct OperandTraits<Int16> {
+        using type = int16_t;
+        static type  get(const Scalar& s) { return s.i16; }
+        static void  set(Scalar& s, type v) { s.i16 = v; }
+    };
+
+    template <> struct OperandTraits<Int32> {
+        using type = int32_t;
+        static type  get(const Scalar& s) { return s.i32; }
+        static void  set(Scalar& s, type v) { s.i32 = v; }
+    };
+
+    template <> struct OperandTraits<Float> {
+        using type = float;
+        static type  get(const Scalar& s) { return s.f32; }
+        static void  set(Scalar& s, type v) { s.f32 = v; }
+    };
+
+    template <> struct OperandTraits<Double> {
+        using type = double;
+        static type  get(const Scalar& s) { return s.f64; }
+        static void  set(Scalar& s, type v) { s.f64 = v; }
+    };
+
+    /*
+        Tagged value: the native value of an operand together with its type.
+        Arithmetic works on the native values, the textual form is only built when
+        someone asks for it (dump, assert, print).
+    */
+    struct Value {
+        eOperandType type;
+        Scalar       raw;
+
+        template <eOperandType Type>
+        static Value make(typename OperandTraits<Type>::type native) {
+            Value value;
+            value.type = Type;
+            value.raw.f64 = 0;
+            OperandTraits<Type>::set(value.raw, native);
+            return value;
+        }
+
+        // Reads the value as any arithmetic type T
+        template <typename T>
+        T to() const {
+            switch (type) {
+                case Int8:   return static_cast<T>(raw.i8);
+                case Int16:  return static_cast<T>(raw.i16);
+                case Int32:  return static_cast<T>(raw.i32);
+                case Float:  return static_cast<T>(raw.f32);
+                case Double: return static_cast<T>(raw.f64);
+            }
+            return T();
+        }
+
+        bool isZero() const {
+            return to<double>() == 0;
+        }
+
+        bool operator==(const Value& rhs) const {
+            if (type != rhs.type) {
+                return false;
+            }
+            if (type == Float || type == Double) {
+                return to<double>() == rhs.to<double>();
+            }
+            return to<long long>() == rhs.to<long long>();
+        }
+
+        /*
+            Writes the textual form of the value into buffer and returns its length.
+            Floating point values use the shortest representation that reads back to the same value.
+        */
+        size_t format(char* buffer, size_t size) const {
+            std::to_chars_result result;
+
+            switch (type) {
+                case Int8:   result = std::to_chars(buffer, buffer + size, static_cast<int>(raw.i8)); break;
+                case Int16:  result = std::to_chars(buffer, buffer + size, raw.i16); break;
+                case Int32:  result = std::to_chars(buffer, buffer + size, raw.i32); break;
+                case Float:  result = std::to_chars(buffer, buffer + size, raw.f32); break;
+                default:     result = std::to_chars(buffer, buffer + size, raw.f64); break;
+            }
+            return result.ptr - buffer;
+        }
+
+        std::string toString() const {
+            char buffer[32];
+            return std::string(buffer, format(buffer, sizeof(buffer)));
+        }
+    };
+
+    /*
+        Native arithmetic with the overflow checks of the operand types.
+        The operation is a template parameter so the compiler keeps only the code of that operation:
+        integers are computed in a wider type and checked against the range of T,
+        floating point results overflow when they reach infinity.
+    */
+    template <eArithOp Op, typename T>
+    T checkedArith(T lhs, T rhs) {
+        if constexpr (std::is_integral_v<T>) {
+            // int32_t is wide enough for any int8/int16 result, int32 results need 64 bits
+            using Wide = std::conditional_t<(sizeof(T) < sizeof(int32_t)), int32_t, int64_t>;
+            Wide left = lhs;
+            Wide right = rhs;
+            Wide result;
+
+            if constexpr (Op == OpAdd) {
+                result = left + right;
+            } else if constexpr (Op == OpSub) {
+                result = left - right;
+            } else if constexpr (Op == OpMul) {
+                result = left * right;
+            } else {
+                if (right == 0) {
+                    throw DivisionByZero();
+                }
+                result = (Op == OpDiv) ? left / right : left % right;
+            }
+
+            if (result < std::numeric_limits<T>::min() || std::numeric_limits<T>::max() < result) {
+                throw Overflow();
+            }
+            return static_cast<T>(result);
+        } else {
+            T result;
+
+            if constexpr (Op == OpAdd) {
+                result = lhs + rhs;
+            } else if constexpr (Op == OpSub) {
+                result = lhs - rhs;
+            } else if constexpr (Op == OpMul) {
+                result = lhs * rhs;
+            } else {
+                if (rhs == 0) {
+                    throw DivisionByZero();
+                }
+                // Computes the floating-point remainder of the division
+                result = (Op == OpDiv) ? lhs / rhs : std::fmod(lhs, rhs);
+            }
+
+            if (std::isinf(result)) {
+                throw Overflow();
+            }
+            return result;
+        }
+    }
+
+    // Same as above with the operation chosen at run time
+    template <typename T>
+    T checkedArith(eArithOp op, T lhs, T rhs) {
+        switch (op) {
+            case OpAdd: return checkedArith<OpAdd>(lhs, rhs);
+            case OpSub: return checkedArith<OpSub>(lhs, rhs);
+            case OpMul: return checkedArith<OpMul>(lhs, rhs);
+            case OpDiv: return checkedArith<OpDiv>(lhs, rhs);
+            default:    return checkedArith<OpMod>(lhs, rhs);
+        }
+    }
+
+    // Converts a value to a type of higher (or equal) precision
+    inline Value convertValue(const Value& value, eOperandType type) {
+        switch (type) {
+            case Int8:   return Value::make<Int8>(value.to<int8_t>());
+            case Int16:  return Value::make<Int16>(value.to<int16_t>());
+            case Int32:  return Value::make<Int32>(value.to<int32_t>());
+            case Float:  return Value::make<Float>(value.to<float>());
+            default:     return Value::make<Double>(value.to<double>());
+        }
+    }
+
+    /*
+        Orders two values of any types by what they are worth, without rounding: integers are
+        compared as integers, everything else as double. Negative, zero or positive like memcmp.
+    */
+    inline int compareValues(const Value& lhs, const Value& rhs) {
+        if (lhs.type <= Int32 && rhs.type <= Int32) {
+            long long left = lhs.to<long long>();
+            long long right = rhs.to<long long>();
+            return (left > right) - (left < right);
+        }
+        double left = lhs.to<double>();
+        double right = rhs.to<double>();
+        return (left > right) - (left < right);
+    }
+
+    inline Value zeroValue(eOperandType type) {
+        return convertValue(Value::make<Int8>(0), type);
+    }
+
+    /*
+        Parses the literal of an operand (the "42" of int8(42)) into a value of the given type,
+        in place with std::from_chars. Parsing stops at the first character that does not belong
+        to the number, as with stoll/strtod. Integers out of the range of their type raise Overflow
+        or Underflow, floating point values beyond the largest finite value raise Overflow.
+    */
+    inline Value parseValue(eOperandType type, std::string_view literal) {
+        const char* begin = literal.data();
+        const char* end = begin + literal.size();
+
+        if (type == Float || type == Double) {
+            double parsed = 0;
+            std::from_chars_result result = std::from_chars(begin, end, parsed);
+
+            if (result.ec == std::errc::invalid_argument) {
+                throw InvalidOperandType();
+            }
+            // out of range with only zeros before the dot means too small: it rounds to zero
+            if (result.ec == std::errc::result_out_of_range) {
+                std::string_view digits = literal.substr(literal[0] == '-' ? 1 : 0);
+                if (digits.substr(0, digits.find('.')).find_first_not_of('0') != std::string_view::npos) {
+                    throw Overflow();
+                }
+                parsed = 0;
+            }
+
+            double max = (type == Float) ? std::numeric_limits<float>::max() : std::numeric_limits<double>::max();
+            if (parsed > max || parsed < -max) {
+                throw Overflow();
+            }
+            return (type == Float) ? Value::make<Float>(static_cast<float>(parsed)) : Value::make<Double>(parsed);
+        }
+
+        long long parsed = 0;
+        std::from_chars_result result = std::from_chars(begin, end, parsed);
+
+        if (result.ec == std::errc::invalid_argument) {
+            throw InvalidOperandType();
+        } else if (result.ec == std::errc::result_out_of_range) {
+            throw Overflow();
+        }
+
+        long long min = (type == Int8) ? std::numeric_limits<int8_t>::min()
+                      : (type == Int16) ? std::numeric_limits<int16_t>::min() : std::numeric_limits<int32_t>::min();
+        long long max = (type == Int8) ? std::numeric_limits<int8_t>::max()
+                      : (type == Int16) ? std::numeric_limits<int16_t>::max() : std::numeric_limits<int32_t>::max();
+
+        if (parsed < min) {
+            throw Underflow();
+        } else if (parsed > max) {
+            throw Overflow();
+        }
+        return convertValue(Value::make<Int32>(static_cast<int32_t>(parsed)), type);
+    }
+#endif
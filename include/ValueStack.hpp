@@ -0,0 +1,331 @@
+#ifndef VALUE_STACK_HPP
+#define VALUE_STACK_HPP
+
+    #include "./Value.hpp"
+    #include <stdlib.h>
+    #include <string.h>
+    #include <algorithm>
+    #include <new>
+    #include <vector>
+
+    /*
+        Stack of values packed by type.
+        Consecutive values of the same type form a segment: a plain native array (int8_t[], int32_t[],
+        double[]...) in one contiguous block of bytes, described by a small header with its type.
+        A value takes its native size only, a segment header is paid once per change of type.
+        Neighbouring segments always have different types, so a region of the stack has a single type
+        exactly when it lies in one segment, and its values can then be read in place as an array.
+
+        Values go in and out as Value, the packing is invisible to the VM: index 0 is the oldest value,
+        size() - 1 the top. The last segment is cached in plain members, so push, pop and the values
+        near the top only ever change count, like an array of Value would.
+    */
+    class ValueStack {
+        public:
+            struct Segment {
+                eOperandType    type;
+                size_t          first;      // index of its first value
+                size_t          offset;     // byte offset of its native array, aligned for its type
+            };
+
+            static const size_t DEFAULT_CAPACITY = 256;
+
+            // Native size of each eOperandType
+            static constexpr size_t SIZES[] = {sizeof(int8_t), sizeof(int16_t), sizeof(int32_t), sizeof(float), sizeof(double)};
+
+            // Room for capacity values of the largest type
+            explicit ValueStack(size_t capacity = DEFAULT_CAPACITY) {
+                reserve((capacity > 0 ? capacity : 1) * sizeof(double));
+            }
+
+            ~ValueStack() {
+                free(bytes);
+            }
+
+            ValueStack(const ValueStack&) = delete;
+            ValueStack& operator=(const ValueStack&) = delete;
+
+            void push(const Value& value) {
+                if (value.type != lastType || count == lastLimit) {
+                    pushSlow(value);
+                    return;
+                }
+                store(slot(count), value.type, value.raw, lastSize);
+                count++;
+            }
+
+            void pop() {
+                count--;
+                if (count == lastFirst) {
+                    closeSegment();
+                }
+            }
+
+            // Drops the n values on top
+            void pop(size_t n) {
+                count -= n;
+                while (!segments.empty() && segments.back().first >= count) {
+                    segments.pop_back();
+                }
+                cacheLast();
+            }
+
+            Value top() const {
+                return load(static_cast<eOperandType>(lastType), slot(count - 1), lastSize);
+            }
+
+            // Replaces the top value, in place when the type does not change
+            void replaceTop(const Value& value) {
+                if (value.type == lastType) {
+                    store(slot(count - 1), value.type, value.raw, lastSize);
+                } else {
+                    replaceSlow(value);
+                }
+            }
+
+            // depth 0 is the top of the stack, depth 1 the value below it...
+            Value fromTop(size_t depth) const {
+                size_t index = count - 1 - depth;
+
+                if (index >= lastFirst) {
+                    return load(static_cast<eOperandType>(lastType), slot(index), lastSize);
+                }
+                return at(index);
+            }
+
+            Value operator[](size_t index) const { return at(index); }
+
+            // Calls visit(value) for every value, from the top down, without searching any segment
+            template <typename Visitor>
+            void forEachFromTop(Visitor visit) const {
+                forEachDown(0, count, visit);
+            }
+
+            // Calls visit(value) for the values [first, end), from end - 1 down: only the segment of end - 1 is searched
+            template <typename Visitor>
+            void forEachDown(size_t first, size_t end, Visitor visit) const {
+                if (first >= end) {
+                    return;
+                }
+
+                size_t index = end;
+
+                for (size_t i = &segmentOf(end - 1) - segments.data() + 1; i > 0 && index > first; i--) {
+                    const Segment& segment = segments[i - 1];
+                    for (size_t stop = std::max(segment.first, first); index > stop; index--) {
+                        visit(load(segment.type, bytes + segment.offset + (index - 1 - segment.first) * SIZES[segment.type]));
+                    }
+                }
+            }
+
+            /*
+                The values [first, first + count) as a native array of T, if they all lie in one segment
+                of the given type, nullptr otherwise. Valid until the stack changes.
+            */
+            template <typename T>
+            const T* native(size_t first, size_t count, eOperandType type) const {
+                const Segment& segment = segmentOf(first);
+
+                if (segment.type != type || first + count > end(segment)) {
+                    return nullptr;
+                }
+                return reinterpret_cast<const T*>(bytes + segment.offset) + (first - segment.first);
+            }
+
+            // True if the values [first, first + count) all have the same type
+            bool isHomogeneous(size_t first, size_t count) const {
+                return count == 0 || first + count <= end(segmentOf(first));
+            }
+
+            const Segment&  segmentOf(size_t index) const {
+                if (index >= lastFirst) {
+                    return segments.back();
+                }
+                // last segment starting at or before index
+                auto next = std::upper_bound(segments.begin(), segments.end(), index,
+                                             [](size_t value, const Segment& segment) { return value < segment.first; });
+                return *(next - 1);
+            }
+
+            size_t          size() const { return count; }
+            bool            empty() const { return count == 0; }
+            size_t          segmentCount() const { return segments.size(); }
+            size_t          capacity() const { return _capacity; }
+            size_t          growths() const { return _growths; }
+
+            // Bytes taken by the values, alignment padding between segments included
+            size_t          bytesUsed() const {
+                return segments.empty() ? 0 : lastOffset + (count - lastFirst) * lastSize;
+            }
+
+            void clear() {
+                count = 0;
+                segments.clear();
+                cacheLast();
+            }
+
+            // The packed values as they are in memory, bytesUsed() bytes described by segmentTable(): what a snapshot saves
+            const char*                 data() const { return bytes; }
+            const std::vector<Segment>& segmentTable() const { return segments; }
+
+            /*
+                Replaces the whole stack by values packed like data() and segmentTable() of another
+                stack: one copy of the block, no work per value. The table must describe size bytes
+                holding values values (see Snapshot.cpp for the checks), it is taken over.
+            */
+            void assign(std::vector<Segment>& table, size_t values, const char* data, size_t size) {
+                clear();
+                reserve(size);
+                if (size > 0) {
+                    memcpy(bytes, data, size);
+                }
+                segments.swap(table);
+                count = values;
+                cacheLast();
+            }
+
+            // Capacity in bytes
+            void reserve(size_t capacity) {
+                if (capacity <= _capacity) {
+                    return;
+                }
+
+                // the segments are plain native values, realloc can move the block as it is
+                char* grown = static_cast<char*>(realloc(bytes, capacity));
+                if (!grown) {
+                    throw std::bad_alloc();
+                }
+
+                if (bytes) {
+                    _growths++;
+                }
+                bytes = grown;
+                _capacity = capacity;
+                cacheLast();
+            }
+
+        private:
+            char*                   bytes = nullptr;
+            size_t                  count = 0;
+            size_t                  _capacity = 0;
+            size_t                  _growths = 0;
+            std::vector<Segment>    segments;
+
+            // Copy of the last segment: no type while the stack is empty, so that push opens one
+            int                     lastType = -1;
+            size_t                  lastFirst = 0;
+            size_t                  lastSize = 1;
+            size_t                  lastOffset = 0;
+            size_t                  lastLimit = 0;      // index of the first value that does not fit
+            uintptr_t               lastBase = 0;       // address the index 0 would have in it
+
+            char* slot(size_t index) const {
+                return reinterpret_cast<char*>(lastBase + index * lastSize);
+            }
+
+            // Index one past the last value of the segment
+            size_t end(const Segment& segment) const {
+                return &segment == &segments.back() ? count : (&segment)[1].first;
+            }
+
+            void cacheLast() {
+                if (segments.empty()) {
+                    lastType = -1;
+                    lastFirst = 0;
+                    lastSize = 1;
+                    lastOffset = 0;
+                    lastLimit = 0;
+                    lastBase = reinterpret_cast<uintptr_t>(bytes);
+                    return;
+                }
+
+                const Segment& last = segments.back();
+                lastType = last.type;
+                lastFirst = last.first;
+                lastSize = SIZES[last.type];
+                lastOffset = last.offset;
+                lastLimit = last.first + (_capacity > last.offset ? (_capacity - last.offset) / lastSize : 0);
+                lastBase = reinterpret_cast<uintptr_t>(bytes) + last.offset - last.first * lastSize;
+            }
+
+            // The rare paths stay out of line, so that push, pop and replaceTop inline into the dispatch loop
+
+            __attribute__((noinline)) Value at(size_t index) const {
+                const Segment& segment = segmentOf(index);
+                return load(segment.type, bytes + segment.offset + (index - segment.first) * SIZES[segment.type]);
+            }
+
+            // New segment or more room
+            __attribute__((noinline)) void pushSlow(const Value& value) {
+                if (value.type != lastType) {
+                    size_t size = SIZES[value.type];
+                    size_t offset = (bytesUsed() + size - 1) / size * size;
+
+                    segments.push_back({value.type, count, offset});
+                    cacheLast();
+                }
+                if (count == lastLimit) {
+                    reserve(std::max(_capacity * 2, bytesUsed() + lastSize));
+                }
+                store(slot(count), value.type, value.raw, lastSize);
+                count++;
+            }
+
+            __attribute__((noinline)) void replaceSlow(const Value& value) {
+                pop();
+                pushSlow(value);
+            }
+
+            // Drops the last segment, which is empty
+            __attribute__((noinline)) void closeSegment() {
+                segments.pop_back();
+                cacheLast();
+            }
+
+            /*
+                Values are moved by size with typed accesses: no jump table on the type next to the one
+                of the dispatch loop, and no char access that the compiler must assume overwrites the
+                members of the stack. A float is stored and loaded as a float, the vector instructions
+                read float segments through native<float>().
+            */
+            static void store(char* at, eOperandType type, const Scalar& raw, size_t size) {
+                if (size == sizeof(int32_t)) {
+                    if (type == Float) {
+                        *reinterpret_cast<float*>(at) = raw.f32;
+                    } else {
+                        *reinterpret_cast<int32_t*>(at) = raw.i32;
+                    }
+                } else if (size == sizeof(double)) {
+                    *reinterpret_cast<double*>(at) = raw.f64;
+                } else if (size == sizeof(int16_t)) {
+                    *reinterpret_cast<int16_t*>(at) = raw.i16;
+                } else {
+                    *reinterpret_cast<int8_t*>(at) = raw.i8;
+                }
+            }
+
+            static Value load(eOperandType type, const char* at, size_t size) {
+                Value value;
+
+                value.type = type;
+                if (size == sizeof(int32_t)) {
+                    if (type == Float) {
+                        value.raw.f32 = *reinterpret_cast<const float*>(at);
+                    } else {
+                        value.raw.i32 = *reinterpret_cast<const int32_t*>(at);
+                    }
+                } else if (size == sizeof(double)) {
+                    value.raw.f64 = *reinterpret_cast<const double*>(at);
+                } else if (size == sizeof(int16_t)) {
+                    value.raw.i16 = *reinterpret_cast<const int16_t*>(at);
+                } else {
+                    value.raw.i8 = *reinterpret_cast<const int8_t*>(at);
+                }
+                return value;
+            }
+
+            static Value load(eOperandType type, const char* at) {
+                return load(type, at, SIZES[type]);
+            }
+    };
+#endif
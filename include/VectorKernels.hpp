@@ -0,0 +1,47 @@
+#ifndef VECTOR_KERNELS_HPP
+#define VECTOR_KERNELS_HPP
+
+    #include <stddef.h>
+    #include <stdint.h>
+
+    /*
+        Exact sum of int32 values, and the sum of the negative ones: every partial sum of the values,
+        in any order, lies between negative and positive()
+    */
+    struct IntSummary {
+        int64_t sum;
+        int64_t negative;
+
+        int64_t positive() const { return sum - negative; }
+    };
+
+    /*
+        Bulk kernels of the vector instructions (sum, addn, mulp), over contiguous native arrays.
+        There is one implementation per instruction set: scalar, SSE4.1 and AVX2. The best one the
+        CPU supports is picked once at run time with CPUID, so one binary runs everywhere.
+
+        Every implementation returns exactly the same results:
+            - integer sums are exact (64 bit accumulators)
+            - floating point sums always use the same 4 lanes, lane k adds the values k, k + 4, ...
+              and the lanes are combined as (0 + 1) + (2 + 3), whatever the register width
+            - products are computed one by one, rounding does not depend on the order
+    */
+    struct VectorKernels {
+        enum eLevel { Scalar, Sse41, Avx2 };
+
+        eLevel          level;
+        const char*     name;
+
+        IntSummary      (*sumInt32)(const int32_t* values, size_t count);
+        double          (*sumDouble)(const double* values, size_t count);
+        void            (*mulDouble)(const double* lhs, const double* rhs, double* result, size_t count);
+
+        // Best kernels for this CPU
+        static const VectorKernels& best();
+
+        // Kernels of the given level, or of the best level below it that the CPU supports
+        static const VectorKernels& forLevel(eLevel level);
+
+        static eLevel               supportedLevel();
+    };
+#endif
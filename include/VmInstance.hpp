@@ -0,0 +1,90 @@
+#ifndef VM_INSTANCE_HPP
+#define VM_INSTANCE_HPP
+
+    #include "./MyAbstractVm.hpp"
+    #include "./Compiler.hpp"
+    #include "./Optimizer.hpp"
+    #include "./BytecodeFile.hpp"
+    #include "./PrefixCache.hpp"
+    #include <memory>
+    #include <string>
+
+    // Outcome of VmInstance::run
+    struct RunResult {
+        eRunStatus  status = Completed;
+        std::string error;              // message of the error when status is Failed
+        size_t      errorLine = 0;      // line that raised it, 0 if the error is not tied to a line
+    };
+
+    /*
+        Entry point for programs that embed the VM (libmy_abstract_vm).
+        An instance loads a program, runs it, and keeps the final stack and the output for the caller.
+        It never ends the host process: exit and every error are reported in the RunResult.
+        reset() clears the stack and the output so the same instance can run the next program.
+
+            VmInstance vm;
+            vm.loadSource("push int32(42)\npush int32(33)\nadd\nexit\n");
+            RunResult result = vm.run();
+            vm.output();                    // "Exiting program...\n"
+            vm.stack().top();               // int32 75
+    */
+    class VmInstance {
+        public:
+            explicit VmInstance(size_t stackCapacity = ValueStack::DEFAULT_CAPACITY);
+
+            // Sources are compiled and optimized, compile errors are thrown as ProgramError, the previously loaded program is kept
+            void                loadSource(const std::string& source);
+
+            // Source (.avm) or compiled (.avmc) file, a compiled file is run from its mapped pages
+            void                loadFile(const std::string& fileName);
+
+            void                loadProgram(const Program& program);
+
+            // Runs the loaded program on the current state, a program without exit fails like in the CLI
+            RunResult           run();
+
+            /*
+                Checkpoints: runTo(pc) runs until the next instruction is at pc or beyond (a jump may go
+                further), checkpoint() saves the state at that point (see MyAbstractVM::saveState), and the
+                next run() goes on from it.
+                restore() takes a checkpoint of the same loaded program back, here or in another process.
+            */
+            RunResult           runTo(size_t pc);
+            std::string         checkpoint() const;
+            void                restore(const char* data, size_t size);
+
+            // Restores a checkpoint written to a file, read from its mapped pages
+            void                restoreFile(const std::string& fileName);
+
+            void                reset();
+
+            /*
+                A run() that starts from an empty stack and no output resumes from the deepest checkpoint
+                of the cache that the loaded program shares, and stores the checkpoints it passes.
+                nullptr stops it. The cache can be shared between instances, it must outlive them.
+            */
+            void                setPrefixCache(PrefixCache* cache) { prefixCache = cache; }
+
+            const ValueStack&   stack() const { return vm.getStack(); }
+            const std::string&  output() { return capturedOutput.str(); }
+
+            // Bytes printed by the program, output() included, also those before a restored checkpoint
+            size_t              outputPosition() const { return capturedOutput.position(); }
+
+        private:
+            MyAbstractVM                    vm;
+            Compiler                        compiler;
+            Optimizer                       optimizer;
+            MemorySink                      capturedOutput;
+            Program                         program;
+            std::unique_ptr<BytecodeFile>   bytecode;
+            size_t                          next = 0;       // where run() starts, set by runTo and restore
+            PrefixCache*                    prefixCache = nullptr;
+            std::vector<uint64_t>           prefixHashes;
+
+            const Instruction*  code() const { return bytecode ? bytecode->data() : program.data(); }
+            size_t              codeSize() const { return bytecode ? bytecode->size() : program.size(); }
+            RunResult           execute(size_t stop, bool exitRequired);
+            eRunStatus          runCached(size_t& pc);
+    };
+#endif
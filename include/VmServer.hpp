@@ -0,0 +1,158 @@
+#ifndef VM_SERVER_HPP
+#define VM_SERVER_HPP
+
+    #include "./VmInstance.hpp"
+    #include <stdint.h>
+    #include <atomic>
+    #include <condition_variable>
+    #include <deque>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <unordered_map>
+    #include <vector>
+
+    /*
+        Protocol of --serve, over a Unix stream socket, in host byte order (the socket is local).
+        A request is a RequestHeader followed by the source of one program. The reply is a ReplyHeader
+        followed by the output of the program, its final stack (one value per line from the top, like
+        dump) and its error message. A client may send its next requests without waiting, the replies
+        come back in the order of the requests.
+    */
+    struct RequestHeader {
+        uint32_t    sourceSize;
+    };
+
+    struct ReplyHeader {
+        uint32_t    status;         // eRunStatus
+        uint32_t    errorLine;      // 0 if the error is not tied to a line
+        uint32_t    outputSize;
+        uint32_t    stackSize;
+        uint32_t    errorSize;
+    };
+
+    // A reply, decoded
+    struct ServerReply {
+        RunResult   result;
+        std::string output;
+        std::string stack;
+    };
+
+    /*
+        Runs programs sent over a Unix domain socket, so that a client pays neither a process start
+        nor the setup of a VM for each of them.
+        One thread runs an epoll loop that accepts connections, reads requests and writes replies.
+        A pool of workers compiles and runs the programs, each worker on its own VmInstance, reset
+        between two programs. A connection has one program running at a time, which keeps its replies
+        in order. Requests wait in a bounded queue: once it is full, or once a client leaves too many
+        replies unread, the loop stops reading the sockets concerned and the clients block on their
+        own writes until the workers catch up.
+    */
+    class VmServer {
+        public:
+            static const size_t MAX_SOURCE_SIZE = 16 * 1024 * 1024;
+            static const size_t MAX_UNSENT_BYTES = 1024 * 1024;        // per connection
+
+            // workers == 0 uses one worker per core, queueLimit == 0 four waiting requests per worker
+            explicit VmServer(const std::string& socketPath, size_t workers = 0, size_t queueLimit = 0);
+            ~VmServer();
+
+            VmServer(const VmServer&) = delete;
+            VmServer& operator=(const VmServer&) = delete;
+
+            // Serves until stop(), SIGINT or SIGTERM, then removes the socket file. Can be called again once it returned
+            void    run();
+
+            // Can be called from any thread, before or during run()
+            void    stop();
+
+            size_t  workerCount() const { return workers; }
+
+            // Shared by every worker, set before run()
+            void    setPrefixCache(PrefixCache* cache) { prefixCache = cache; }
+
+        private:
+            struct Job {
+                uint64_t    connection;
+                std::string source;
+            };
+
+            struct Done {
+                uint64_t    connection;
+                std::string reply;
+            };
+
+            struct Connection {
+                int         fd;
+                uint32_t    events = 0;         // epoll interest currently registered
+                std::string input;              // received bytes not yet handed to a worker
+                std::string unsent;             // replies not yet written
+                size_t      sent = 0;           // bytes of unsent already written
+                bool        running = false;    // one of its programs is on a worker
+                bool        queued = false;     // has a complete request waiting for room in the queue
+                bool        peerClosed = false; // the client will not send anything more
+                bool        hungUp = false;     // EPOLLHUP seen: only watched while a reply waits to be written
+            };
+
+            std::string                                 socketPath;
+            size_t                                      workers;
+            size_t                                      queueLimit;
+            PrefixCache*                                prefixCache = nullptr;
+
+            int                                         listenFd = -1;
+            int                                         epollFd = -1;
+            int                                         wakeFd = -1;        // eventfd: a worker finished, or stop()
+            int                                         signalFd = -1;
+            std::atomic<bool>                           stopRequested{false};
+
+            std::unordered_map<uint64_t, Connection>    connections;
+            uint64_t                                    nextConnection;
+            std::deque<uint64_t>                        waiting;            // connections with a request and no room
+
+            // Shared with the workers
+            std::mutex                                  lock;
+            std::condition_variable                     ready;
+            std::deque<Job>                             jobs;
+            std::deque<Done>                            finished;
+            bool                                        stopping = false;
+            std::vector<std::thread>                    pool;
+
+            void        openSocket();
+            void        work();
+            void        closeAll();
+
+            void        acceptConnections();
+            void        receive(uint64_t id, Connection& connection);
+            void        transmit(uint64_t id, Connection& connection);
+            void        hangUp(uint64_t id, Connection& connection);
+            void        collect();
+
+            // Hands the next request of the connection to the workers if it can, then updates its epoll interest
+            void        update(uint64_t id, Connection& connection);
+            bool        dispatch(uint64_t id, Connection& connection);
+            void        closeConnection(uint64_t id);
+
+            static std::string  execute(VmInstance& vm, const std::string& source);
+            static bool         hasRequest(const Connection& connection);
+    };
+
+    // Blocking client of VmServer, over one connection
+    class VmClient {
+        public:
+            explicit VmClient(const std::string& socketPath);
+            ~VmClient();
+
+            VmClient(const VmClient&) = delete;
+            VmClient& operator=(const VmClient&) = delete;
+
+            // Sends a program and waits for its reply
+            ServerReply run(const std::string& source);
+
+            // Pipelining: send several programs, then receive their replies in the same order
+            void        send(const std::string& source);
+            ServerReply receive();
+
+        private:
+            int fd;
+    };
+#endif
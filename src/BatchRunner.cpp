@@ -0,0 +1,151 @@
+#include "../include/BatchRunner.hpp"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+
+// One queue of file indexes per worker, the owner takes from the front and thieves from the back
+struct WorkQueue {
+    std::mutex          lock;
+    std::deque<size_t>  indexes;
+
+    bool take(size_t& index, bool fromFront) {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (indexes.empty()) {
+            return false;
+        }
+        if (fromFront) {
+            index = indexes.front();
+            indexes.pop_front();
+        } else {
+            index = indexes.back();
+            indexes.pop_back();
+        }
+        return true;
+    }
+};
+
+BatchRunner::BatchRunner(size_t threads) : threads(threads) {
+    if (this->threads == 0) {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+static bool hasProgramExtension(const std::string& name) {
+    auto endsWith = [&name](const std::string& suffix) {
+        return name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return endsWith(".avm") || endsWith(".avmc");
+}
+
+std::vector<std::string> BatchRunner::collectFiles(const std::string& source) {
+    std::vector<std::string> files;
+    struct stat info;
+
+    if (stat(source.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        DIR* directory = opendir(source.c_str());
+        if (!directory) {
+            throw InvalidFile();
+        }
+
+        while (struct dirent* entry = readdir(directory)) {
+            std::string name = entry->d_name;
+            if (hasProgramExtension(name)) {
+                files.push_back(source + "/" + name);
+            }
+        }
+        closedir(directory);
+        std::sort(files.begin(), files.end());
+    } else if (source.find_first_of("*?[") != std::string::npos) {
+        glob_t matches;
+
+        if (glob(source.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; i++) {
+                files.push_back(matches.gl_pathv[i]);
+            }
+        }
+        globfree(&matches);
+    } else {
+        std::ifstream manifest(source);
+        if (!manifest) {
+            throw InvalidFile();
+        }
+
+        size_t slash = source.rfind('/');
+        std::string base = slash == std::string::npos ? "" : source.substr(0, slash + 1);
+        std::string line;
+
+        while (std::getline(manifest, line)) {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line.at(0) == '#') {
+                continue;
+            }
+            files.push_back(line.at(0) == '/' ? line : base + line);
+        }
+    }
+
+    return files;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<std::string>& files) {
+    std::vector<BatchResult> results(files.size());
+    size_t workers = std::min(threads, std::max<size_t>(files.size(), 1));
+    std::vector<WorkQueue> queues(workers);
+
+    // contiguous blocks keep neighbouring files on the same worker until stealing starts
+    for (size_t i = 0; i < files.size(); i++) {
+        queues[i * workers / files.size()].indexes.push_back(i);
+    }
+
+    auto work = [&](size_t self) {
+        VmInstance vm;
+        size_t index;
+
+        vm.setPrefixCache(prefixCache);
+
+        while (true) {
+            bool found = queues[self].take(index, true);
+
+            for (size_t other = 1; !found && other < workers; other++) {
+                found = queues[(self + other) % workers].take(index, false);
+            }
+            if (!found) {
+                return;
+            }
+
+            BatchResult& entry = results[index];
+            entry.fileName = files[index];
+
+            try {
+                vm.loadFile(files[index]);
+                entry.result = vm.run();
+            } catch (const ProgramError& e) {
+                entry.result.status = Failed;
+                entry.result.error = e.what();
+                entry.result.errorLine = e.line();
+            } catch (const std::exception& e) {
+                entry.result.status = Failed;
+                entry.result.error = e.what();
+            }
+
+            entry.output = vm.output();
+            vm.reset();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < workers; i++) {
+        pool.emplace_back(work, i);
+    }
+    work(0);
+
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return results;
+}
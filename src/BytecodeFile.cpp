@@ -0,0 +1,69 @@
+#include "../include/BytecodeFile.hpp"
+#include <fstream>
+#include <string.h>
+
+static const char AVMC_MAGIC[4] = { 'A', 'V', 'M', 'C' };
+
+void BytecodeFile::write(const std::string& fileName, const Program& program) {
+    BytecodeHeader header = {};
+    memcpy(header.magic, AVMC_MAGIC, sizeof(AVMC_MAGIC));
+    header.version = AVMC_VERSION;
+    header.instructionSize = sizeof(Instruction);
+    header.flags = program.hasExit() ? AVMC_HAS_EXIT : 0;
+    header.count = program.size();
+    header.checksum = instructionChecksum(program.data(), program.size());
+
+    std::ofstream outfile(fileName, std::ios::binary | std::ios::trunc);
+    if (!outfile) {
+        throw InvalidFile();
+    }
+
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outfile.write(reinterpret_cast<const char*>(program.data()), program.size() * sizeof(Instruction));
+
+    if (!outfile) {
+        throw InvalidFile();
+    }
+}
+
+bool BytecodeFile::isBytecode(const std::string& fileName) {
+    std::ifstream infile(fileName, std::ios::binary);
+    char magic[4] = {};
+
+    infile.read(magic, sizeof(magic));
+    return infile && memcmp(magic, AVMC_MAGIC, sizeof(AVMC_MAGIC)) == 0;
+}
+
+BytecodeFile::BytecodeFile(const std::string& fileName) : file(fileName) {
+    if (file.size() < sizeof(BytecodeHeader)) {
+        throw InvalidBytecode();
+    }
+
+    const BytecodeHeader* header = reinterpret_cast<const BytecodeHeader*>(file.data());
+    size_t payload = file.size() - sizeof(BytecodeHeader);
+
+    // a stale file (older version or layout) is rejected the same way as a corrupted one
+    if (memcmp(header->magic, AVMC_MAGIC, sizeof(AVMC_MAGIC)) != 0
+        || header->version != AVMC_VERSION
+        || header->instructionSize != sizeof(Instruction)
+        || header->count != payload / sizeof(Instruction)
+        || payload % sizeof(Instruction) != 0) {
+        throw InvalidBytecode();
+    }
+
+    code = reinterpret_cast<const Instruction*>(file.data() + sizeof(BytecodeHeader));
+    count = header->count;
+    _hasExit = header->flags & AVMC_HAS_EXIT;
+
+    if (header->checksum != instructionChecksum(code, count)) {
+        throw InvalidBytecode();
+    }
+
+    // the records are run as they are, so every opcode and type must be known, and every jump land in the program
+    for (size_t i = 0; i < count; i++) {
+        if (code[i].opcode >= INSTRUCTION_TYPES || code[i].type > Double
+            || (isJump(code[i].opcode) && code[i].target() > count)) {
+            throw InvalidBytecode();
+        }
+    }
+}
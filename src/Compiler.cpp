@@ -0,0 +1,267 @@
+#include "../include/Compiler.hpp"
+#include "../include/MappedFile.hpp"
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <string.h>
+
+// Part of a text compiled by one thread, line numbers are local to the chunk until it is stitched
+struct Chunk {
+    std::string_view    text;
+    Program             program;
+    uint32_t            lines = 0;
+    uint32_t            errorLine = 0;
+    std::exception_ptr  error;
+};
+
+/*
+    Compiles the lines of a chunk up to its end or its first error. An exit does not stop it:
+    whether the code after the exit counts depends on the jumps of the chunks before it.
+*/
+static void compileChunk(Compiler& compiler, Chunk& chunk) {
+    const char* cursor = chunk.text.data();
+    const char* end = cursor + chunk.text.size();
+
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline ? newline : end;
+
+        chunk.lines++;
+        try {
+            compiler.compileLine(std::string_view(cursor, lineEnd - cursor), chunk.lines, chunk.program);
+        } catch (const ProgramError& e) {
+            chunk.error = std::current_exception();
+            chunk.errorLine = chunk.lines;
+            return;
+        }
+        cursor = newline ? newline + 1 : end;
+    }
+}
+
+Program Compiler::compile(std::istream& input) {
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return compileBuffer(text, 1);
+}
+
+bool Compiler::compileLine(std::string_view line, uint32_t lineNumber, Program& program) {
+    try {
+        LineTokens tokens = tokenizeLine(line);
+
+        if (!tokens.label.empty()) {
+            program.defineLabel(tokens.label, lineNumber);
+        }
+        if (tokens.instruction == Nil) {
+            return false;
+        }
+
+        Instruction instruction = {};
+        instruction.opcode = tokens.instruction;
+        instruction.line = lineNumber;
+
+        if (isJump(tokens.instruction)) {
+            program.appendJump(instruction, tokens.target);
+            return true;
+        }
+
+        // decode the operand once, e.g. int32 and 42
+        if (takesOperand(tokens.instruction)) {
+            eOperandType type;
+
+            if (!tokens.hasOperand || !matchOperandType(tokens.type, type)) {
+                throw InvalidOperandType();
+            }
+
+            Value value = parseValue(type, tokens.value);
+            instruction.type = value.type;
+            instruction.immediate = value.raw;
+
+            // the operand of a vector instruction is its count of values: addn needs 2, mulp 1 pair
+            if ((tokens.instruction == AddN || tokens.instruction == MulPairs)
+                && (type == Float || type == Double || value.to<int32_t>() < (tokens.instruction == AddN ? 2 : 1))) {
+                throw InvalidOperandType();
+            }
+        }
+
+        program.append(instruction);
+        return true;
+    } catch (const std::exception& e) {
+        throw ProgramError(lineNumber, e);
+    }
+}
+
+Program Compiler::compileBuffer(std::string_view text, size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t count = std::max<size_t>(1, std::min(threads, text.size() / MIN_CHUNK_SIZE));
+
+    // cut the text in about equal chunks, each one ends right after a newline
+    std::vector<Chunk> chunks(count);
+    size_t start = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t end = (i + 1 == count) ? text.size() : std::max(start, text.size() * (i + 1) / count);
+
+        if (end < text.size()) {
+            size_t newline = text.find('\n', end);
+            end = (newline == std::string_view::npos) ? text.size() : newline + 1;
+        }
+        chunks[i].text = text.substr(start, end - start);
+        start = end;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; i++) {
+        workers.emplace_back([this, &chunks, i]() { compileChunk(*this, chunks[i]); });
+    }
+    compileChunk(*this, chunks[0]);
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // stitch the chunks in order, nothing after the first error counts
+    size_t total = 0;
+    for (const Chunk& chunk : chunks) {
+        total += chunk.program.size();
+    }
+
+    Program program;
+    program.reserve(total);
+    uint32_t offset = 0;
+    const Chunk* failed = nullptr;
+
+    for (const Chunk& chunk : chunks) {
+        uint32_t base = program.size();
+
+        for (size_t i = 0; i < chunk.program.size(); i++) {
+            Instruction instruction = chunk.program.data()[i];
+            instruction.line += offset;
+            program.append(instruction);
+        }
+        for (const LabelMark& label : chunk.program.labels()) {
+            program.labels().push_back({label.name, base + label.pc, offset + label.line});
+        }
+        for (const LabelMark& jump : chunk.program.jumps()) {
+            program.jumps().push_back({jump.name, base + jump.pc, offset + jump.line});
+        }
+
+        if (chunk.error) {
+            failed = &chunk;
+            break;
+        }
+        // what follows the first exit can only run if a jump before it leads there
+        if (program.hasExit() && !jumpsPastExit(program)) {
+            break;
+        }
+        offset += chunk.lines;
+    }
+
+    if (program.hasExit() && !jumpsPastExit(program)) {
+        // the chunk of the exit went on to the end of its text, an error there comes after the exit
+        program.truncate(program.firstExit() + 1);
+    } else if (failed) {
+        try {
+            std::rethrow_exception(failed->error);
+        } catch (const ProgramError& e) {
+            throw ProgramError(offset + failed->errorLine, e.cause());
+        }
+    }
+
+    link(program);
+    return program;
+}
+
+bool Compiler::jumpsPastExit(const Program& program) {
+    if (program.jumps().empty() || !program.hasExit()) {
+        return false;
+    }
+
+    std::unordered_set<std::string_view> defined;
+    for (const LabelMark& label : program.labels()) {
+        if (label.pc <= program.firstExit()) {
+            defined.insert(label.name);
+        }
+    }
+    for (const LabelMark& jump : program.jumps()) {
+        if (jump.pc < program.firstExit() && !defined.count(jump.name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Compiler::link(Program& program, bool partial) {
+    std::vector<LabelMark>& jumps = program.jumps();
+    std::unordered_map<std::string_view, uint32_t> targets;
+
+    for (const LabelMark& label : program.labels()) {
+        if (!targets.emplace(label.name, label.pc).second) {
+            throw ProgramError(label.line, DuplicateLabel());
+        }
+    }
+
+    size_t pending = 0;
+    for (LabelMark& jump : jumps) {
+        auto found = targets.find(jump.name);
+
+        if (found != targets.end()) {
+            program.data()[jump.pc].setTarget(found->second);
+        } else if (partial) {
+            if (&jumps[pending] != &jump) {
+                jumps[pending] = std::move(jump);
+            }
+            pending++;
+        } else {
+            throw ProgramError(jump.line, UnknownLabel());
+        }
+    }
+    jumps.resize(pending);
+}
+
+void IncrementalLinker::update(Program& program) {
+    std::vector<LabelMark>& marks = program.labels();
+
+    for (; labels < marks.size(); labels++) {
+        const LabelMark& label = marks[labels];
+
+        if (!targets.emplace(label.name, label.pc).second) {
+            throw ProgramError(label.line, DuplicateLabel());
+        }
+
+        auto found = waiting.find(label.name);
+        if (found != waiting.end()) {
+            for (uint32_t pc : found->second) {
+                program.data()[pc].setTarget(label.pc);
+                pending.erase(pc);
+            }
+            waiting.erase(found);
+        }
+    }
+
+    for (LabelMark& jump : program.jumps()) {
+        auto found = targets.find(jump.name);
+
+        if (found != targets.end()) {
+            program.data()[jump.pc].setTarget(found->second);
+        } else {
+            waiting[jump.name].push_back(jump.pc);
+            pending.emplace(jump.pc, jump.line);
+        }
+    }
+    program.jumps().clear();
+}
+
+void IncrementalLinker::finish() const {
+    if (!pending.empty()) {
+        throw ProgramError(pending.begin()->second, UnknownLabel());
+    }
+}
+
+Program Compiler::compileFile(const std::string& fileName, size_t threads) {
+    MappedFile file(fileName);
+    return compileBuffer(file.text(), threads);
+}
@@ -0,0 +1,52 @@
+#include "../include/MyAbstractVm.hpp"
+
+/*
+    Stack helpers and calls of the control flow instructions. The jumps themselves are handled by
+    the execution loop (Interpreter.cpp). These are kept out of line: the loop is one function, and
+    inlining them there costs registers to every other handler.
+*/
+
+void MyAbstractVM::dup() {
+    if (stack.empty()) {
+        throw EmptyStack();
+    }
+    stack.push(stack.top());
+}
+
+void MyAbstractVM::swap() {
+    if (stack.size() < 2) {
+        throw LessThanTwoValues();
+    }
+    Value top = stack.fromTop(0);
+    Value second = stack.fromTop(1);
+
+    stack.pop();
+    stack.replaceTop(top);
+    stack.push(second);
+}
+
+bool MyAbstractVM::branch(uint8_t opcode) {
+    if (stack.size() < 2) {
+        throw LessThanTwoValues();
+    }
+    int order = compareValues(stack.fromTop(0), stack.fromTop(1));
+
+    stack.pop(2);
+    return jumpTaken(opcode, order);
+}
+
+void MyAbstractVM::call(size_t returnTo) {
+    if (calls.size() == MAX_CALL_DEPTH) {
+        throw CallStackOverflow();
+    }
+    calls.push_back(static_cast<uint32_t>(returnTo));
+}
+
+size_t MyAbstractVM::ret() {
+    if (calls.empty()) {
+        throw ReturnWithoutCall();
+    }
+    size_t returnTo = calls.back();
+    calls.pop_back();
+    return returnTo;
+}
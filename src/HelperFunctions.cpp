@@ -1,17 +1,5 @@
 #include "../include/MyAbstractVm.hpp"
 
-bool MyAbstractVM::isSamePrecision(IOperand* type1, IOperand* type2) const {
-    return type1->getPrecision() == type2->getPrecision();
-}
-
-IOperand* MyAbstractVM::getLowerPrecision(IOperand* type1, IOperand* type2) const {
-    if (type1->getPrecision() > type2->getPrecision()) {
-        return type2;
-    } else {
-        return type1;
-    }
-}
-
 bool MyAbstractVM::checkStackSize() {
     if (stack.size() >= 2) {
         return true;
@@ -20,51 +8,42 @@ bool MyAbstractVM::checkStackSize() {
     return false;
 }
 
-/* If operand are not the same precision compare them, change them and perform the operation */
-IOperand* MyAbstractVM::handlePrecisionAndConvert(IOperand* operand1, IOperand* operand2, OperationFunc operation) {
-    IOperand* result = nullptr;
-
-    const IOperand* higherPrecisionOperand;
-    const IOperand* lowerPrecisionOperand;
-
-    if (operand1->getPrecision() > operand2->getPrecision()) {
-        higherPrecisionOperand = operand1;
-        lowerPrecisionOperand = operand2;
-    } else {
-        higherPrecisionOperand = operand2;
-        lowerPrecisionOperand = operand1;
-    }
-
-    std::string lowerPrecisionValue = lowerPrecisionOperand->toString();
-    IOperand* convertedOperand = factory.createOperand(higherPrecisionOperand->getType(), lowerPrecisionValue);
+/*
+    operand1 is the top of the stack, operand2 the value below it.
+    The kernel for the pair of types converts the operand of lower precision itself.
+*/
+void MyAbstractVM::applyOperation(eArithOp op) {
+    // Check if there's enough values in stack
+    checkStackSize();
 
-    result = operation(*higherPrecisionOperand, *convertedOperand);
-    delete convertedOperand;
+    Value operand1 = stack.fromTop(0);
+    Value operand2 = stack.fromTop(1);
 
-    return result;
-}
-
-IOperand* MyAbstractVM::createHigherPrecisionZero(IOperand* operand1, IOperand* operand2) {
-    const IOperand* higherPrecisionOperand = operand1->getPrecision() > operand2->getPrecision() ? operand1 : operand2;
-    return factory.createOperand(higherPrecisionOperand->getType(), (std::string &) "0");
-}
-
-IOperand* MyAbstractVM::addOperands(const IOperand& op1, const IOperand& op2) {
-    return op1 + op2;
-}
+    Value result = findArithKernel(operand1.type, operand2.type, op)(operand1, operand2);
 
-IOperand* MyAbstractVM::subOperands(const IOperand& op1, const IOperand& op2) {
-    return op1 - op2;
+    // the stack is only changed once the operation succeeded
+    stack.pop();
+    stack.replaceTop(result);
 }
 
-IOperand* MyAbstractVM::mulOperands(const IOperand& op1, const IOperand& op2) {
-    return op1 * op2;
-}
+/*
+    Same as applyOperation with the pushed value as operand1: the stack needs one value, not two.
+    If the operation fails the value is pushed, the stack is then the one push and op would leave.
+*/
+void MyAbstractVM::pushOperation(const Value& operand1, eArithOp op) {
+    if (stack.empty()) {
+        stack.push(operand1);
+        throw LessThanTwoValues();
+    }
 
-IOperand* MyAbstractVM::divOperands(const IOperand& op1, const IOperand& op2) {
-    return op1 / op2;
-}
+    Value operand2 = stack.top();
+    Value result;
 
-IOperand* MyAbstractVM::modOperands(const IOperand& op1, const IOperand& op2) {
-    return op1 % op2;
+    try {
+        result = findArithKernel(operand1.type, operand2.type, op)(operand1, operand2);
+    } catch (const std::exception&) {
+        stack.push(operand1);
+        throw;
+    }
+    stack.replaceTop(result);
 }
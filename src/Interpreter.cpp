@@ -0,0 +1,298 @@
+#include "../include/MyAbstractVm.hpp"
+
+/*
+    Execution loop of a compiled program: every operand is already decoded,
+    so each step only dispatches on the opcode.
+
+    With GCC/Clang the loop is threaded: every handler ends with its own computed goto to the
+    handler of the next instruction, so there is no central switch and no bounds check.
+    The handler is read from a table indexed by the opcode, the instruction records are never
+    rewritten so they can still be run from a read-only mapped .avmc file.
+    Build with -DAVM_SWITCH_DISPATCH (make DISPATCH=switch) to use the portable switch loop instead.
+
+    Jumps set pc to their target, which the loop reads from the instruction. The pc lives in a
+    local variable while the loop runs and is only written back to the caller when it returns.
+
+    The loop is a template over an observer that sees every instruction before it runs and the
+    end of the loop. Without a PairCounter or a Profiler attached it is instantiated with
+    NoObserver, whose empty calls are compiled away: the plain loop pays nothing for them.
+*/
+#if defined(__GNUC__) && !defined(AVM_SWITCH_DISPATCH)
+    #define AVM_THREADED_DISPATCH
+#endif
+
+struct NoObserver {
+    void step(const Instruction&, const ValueStack&) {}
+    void finish(const ValueStack&) {}
+};
+
+struct PairObserver {
+    PairCounter& counter;
+
+    void step(const Instruction& instruction, const ValueStack&) { counter.record(instruction.opcode); }
+    void finish(const ValueStack&) {}
+};
+
+eRunStatus MyAbstractVM::run(const Instruction* code, size_t count) {
+    size_t pc = 0;
+    return run(code, count, pc);
+}
+
+eRunStatus MyAbstractVM::run(const Instruction* code, size_t count, size_t& pc) {
+    if (profiler) {
+        return execute(code, count, pc, *profiler);
+    }
+    if (pairCounter) {
+        PairObserver observer{*pairCounter};
+        return execute(code, count, pc, observer);
+    }
+    NoObserver observer;
+    return execute(code, count, pc, observer);
+}
+
+#ifdef AVM_THREADED_DISPATCH
+
+template <typename Observer>
+eRunStatus MyAbstractVM::execute(const Instruction* code, size_t count, size_t& position, Observer& observer) {
+    // handler addresses, indexed by eInstructionType
+    static const void* const handlers[] = {
+        &&do_push, &&do_pop, &&do_dump, &&do_assert, &&do_add, &&do_sub,
+        &&do_mul, &&do_div, &&do_mod, &&do_print, &&do_exit, &&do_nil,
+        &&do_sum, &&do_addn, &&do_mulp,
+        &&do_jmp, &&do_branch, &&do_branch, &&do_branch, &&do_branch, &&do_branch, &&do_branch,
+        &&do_call, &&do_ret, &&do_dup, &&do_swap,
+        &&do_push_add, &&do_push_sub, &&do_push_mul, &&do_push_div, &&do_push_mod,
+        &&do_assert_pop, &&do_dump_pop,
+    };
+    static_assert(sizeof(handlers) / sizeof(*handlers) == INSTRUCTION_TYPES, "one handler per opcode");
+
+    size_t pc = position;
+
+    #define DISPATCH() do {                                 \
+            if (pc >= count) goto do_end;                   \
+            observer.step(code[pc], stack);                 \
+            goto *handlers[code[pc].opcode];                \
+        } while (0)
+    #define NEXT() do { ++pc; DISPATCH(); } while (0)
+
+    try {
+        DISPATCH();
+
+        do_push:
+            push(code[pc].operand());
+            NEXT();
+        do_pop:
+            pop();
+            NEXT();
+        do_dump:
+            dump();
+            NEXT();
+        do_assert:
+            assert(code[pc].operand());
+            NEXT();
+        do_add:
+            add();
+            NEXT();
+        do_sub:
+            sub();
+            NEXT();
+        do_mul:
+            mul();
+            NEXT();
+        do_div:
+            div();
+            NEXT();
+        do_mod:
+            mod();
+            NEXT();
+        do_print:
+            print();
+            NEXT();
+        do_sum:
+            sum();
+            NEXT();
+        do_addn:
+            addTop(code[pc].operand().to<int32_t>());
+            NEXT();
+        do_mulp:
+            mulPairs(code[pc].operand().to<int32_t>());
+            NEXT();
+        do_push_add:
+            pushOperation(code[pc].operand(), OpAdd);
+            NEXT();
+        do_push_sub:
+            pushOperation(code[pc].operand(), OpSub);
+            NEXT();
+        do_push_mul:
+            pushOperation(code[pc].operand(), OpMul);
+            NEXT();
+        do_push_div:
+            pushOperation(code[pc].operand(), OpDiv);
+            NEXT();
+        do_push_mod:
+            pushOperation(code[pc].operand(), OpMod);
+            NEXT();
+        do_assert_pop:
+            assert(code[pc].operand());
+            stack.pop();
+            NEXT();
+        do_dump_pop:
+            dump();
+            pop();
+            NEXT();
+        do_nil:
+            NEXT();
+        do_exit:
+            position = pc;
+            exitProgram();
+            observer.finish(stack);
+            return Exited;
+        do_end:
+            position = pc;
+            output->flush();
+            observer.finish(stack);
+            return Completed;
+        do_jmp:
+            pc = code[pc].target();
+            DISPATCH();
+        do_branch:
+            pc = branch(code[pc].opcode) ? code[pc].target() : pc + 1;
+            DISPATCH();
+        do_call:
+            call(pc + 1);
+            pc = code[pc].target();
+            DISPATCH();
+        do_ret:
+            pc = ret();
+            DISPATCH();
+        do_dup:
+            dup();
+            NEXT();
+        do_swap:
+            swap();
+            NEXT();
+    } catch (const std::exception& e) {
+        position = pc;
+        observer.finish(stack);
+        output->flush();
+        throw ProgramError(code[pc].line, e);
+    }
+
+    #undef DISPATCH
+    #undef NEXT
+}
+
+#else
+
+template <typename Observer>
+eRunStatus MyAbstractVM::execute(const Instruction* code, size_t count, size_t& position, Observer& observer) {
+    size_t pc = position;
+
+    try {
+        while (pc < count) {
+            const Instruction& instruction = code[pc];
+
+            observer.step(instruction, stack);
+
+            switch (instruction.opcode) {
+                case Push:
+                    push(instruction.operand());
+                    break;
+                case Pop:
+                    pop();
+                    break;
+                case Dump:
+                    dump();
+                    break;
+                case Assert:
+                    assert(instruction.operand());
+                    break;
+                case Add:
+                    add();
+                    break;
+                case Sub:
+                    sub();
+                    break;
+                case Mul:
+                    mul();
+                    break;
+                case Div:
+                    div();
+                    break;
+                case Mod:
+                    mod();
+                    break;
+                case Print:
+                    print();
+                    break;
+                case Sum:
+                    sum();
+                    break;
+                case AddN:
+                    addTop(instruction.operand().to<int32_t>());
+                    break;
+                case MulPairs:
+                    mulPairs(instruction.operand().to<int32_t>());
+                    break;
+                case PushAdd:
+                case PushSub:
+                case PushMul:
+                case PushDiv:
+                case PushMod:
+                    pushOperation(instruction.operand(), static_cast<eArithOp>(instruction.opcode - PushAdd));
+                    break;
+                case AssertPop:
+                    assert(instruction.operand());
+                    stack.pop();
+                    break;
+                case DumpPop:
+                    dump();
+                    pop();
+                    break;
+                case Jmp:
+                    pc = instruction.target();
+                    continue;
+                case Jeq:
+                case Jne:
+                case Jlt:
+                case Jle:
+                case Jgt:
+                case Jge:
+                    pc = branch(instruction.opcode) ? instruction.target() : pc + 1;
+                    continue;
+                case Call:
+                    call(pc + 1);
+                    pc = instruction.target();
+                    continue;
+                case Ret:
+                    pc = ret();
+                    continue;
+                case Dup:
+                    dup();
+                    break;
+                case Swap:
+                    swap();
+                    break;
+                case Exit:
+                    position = pc;
+                    exitProgram();
+                    observer.finish(stack);
+                    return Exited;
+                default:
+                    break;
+            }
+            pc++;
+        }
+        output->flush();
+    } catch (const std::exception& e) {
+        position = pc;
+        observer.finish(stack);
+        output->flush();
+        throw ProgramError(code[pc].line, e);
+    }
+    position = pc;
+    observer.finish(stack);
+    return Completed;
+}
+
+#endif
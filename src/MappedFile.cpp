@@ -0,0 +1,38 @@
+#include "../include/MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw InvalidFile();
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        throw InvalidFile();
+    }
+
+    _size = info.st_size;
+
+    // an empty file cannot be mapped, it is just an empty text
+    if (_size > 0) {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw InvalidFile();
+        }
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(mapping);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (_data) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+}
@@ -1,41 +1,314 @@
 #include "../include/MyAbstractVm.hpp"
-#include "../include/InstructionParser.hpp"
+#include "../include/Compiler.hpp"
+#include "../include/Optimizer.hpp"
+#include "../include/BytecodeFile.hpp"
+#include "../include/StreamRunner.hpp"
+#include "../include/BatchRunner.hpp"
+#include "../include/VmServer.hpp"
+#include "../include/RegisterTranslator.hpp"
+#include <chrono>
 
+static const size_t PAIRS_REPORTED = 10;
+
+// Options of --batch and --serve after their first argument: -j N, --prefix-cache MB
+struct PoolOptions {
+    size_t threads = 0;
+    size_t cacheMegabytes = 0;
+};
+
+static const size_t MAX_THREADS = 1024;
+static const size_t MAX_CACHE_MEGABYTES = 65536;
+static const size_t MAX_LINE = UINT32_MAX;
+
+// Decimal value in [1, max], InvalidOption otherwise
+static size_t optionValue(const char* text, size_t max) {
+    size_t value = 0;
+
+    for (const char* c = text; *c; c++) {
+        if (*c < '0' || *c > '9' || value > max) {
+            throw InvalidOption();
+        }
+        value = value * 10 + (*c - '0');
+    }
+    if (value < 1 || value > max) {
+        throw InvalidOption();
+    }
+    return value;
+}
+
+static PoolOptions poolOptions(int argc, char* argv[], int first) {
+    PoolOptions options;
+
+    for (int i = first; i < argc; i += 2) {
+        std::string option = argv[i];
+
+        if (i + 1 == argc) {
+            throw InvalidOption();
+        } else if (option == "-j") {
+            options.threads = optionValue(argv[i + 1], MAX_THREADS);
+        } else if (option == "--prefix-cache") {
+            options.cacheMegabytes = optionValue(argv[i + 1], MAX_CACHE_MEGABYTES);
+        } else {
+            throw InvalidOption();
+        }
+    }
+    return options;
+}
+
+static void reportCache(PrefixCache& cache) {
+    PrefixCache::Stats stats = cache.stats();
+
+    std::cerr << "prefix cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.skipped << " instructions skipped, " << stats.entries << " checkpoints ("
+              << stats.bytes / 1024 << " KB), " << stats.evictions << " evicted" << std::endl;
+}
+
+// Runs every program of the batch and prints their output and errors in input order
+static int runBatch(const std::string& source, const PoolOptions& options) {
+    BatchRunner runner(options.threads);
+    PrefixCache cache(options.cacheMegabytes << 20);
+
+    if (options.cacheMegabytes > 0) {
+        runner.setPrefixCache(&cache);
+    }
+    std::vector<std::string> files = BatchRunner::collectFiles(source);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runner.run(files);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t failed = 0;
+    for (const BatchResult& entry : results) {
+        std::cout << "==> " << entry.fileName << std::endl << entry.output << std::flush;
+
+        if (entry.result.status == Failed) {
+            std::cerr << entry.fileName << ": " << entry.result.error << std::endl;
+            failed++;
+        }
+    }
+
+    std::cerr << results.size() << " programs, " << failed << " failed, " << runner.threadCount() << " threads, "
+              << elapsed.count() << "s" << std::endl;
+    if (options.cacheMegabytes > 0) {
+        reportCache(cache);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Prints the most frequent opcode pairs executed by the program, to choose new fused instructions
+static void reportPairs(const PairCounter& counter) {
+    std::cerr << "count\tfirst\tsecond" << std::endl;
+    for (const PairCounter::Pair& pair : counter.top(PAIRS_REPORTED)) {
+        std::cerr << pair.count << "\t" << instructionName(pair.first) << "\t" << instructionName(pair.second) << std::endl;
+    }
+}
+
+// Prints the profile as a table, and writes it as JSON when a path is given
+static void reportProfile(const Profiler& profiler, const char* jsonPath) {
+    profiler.writeTable(std::cerr);
+
+    if (jsonPath) {
+        std::ofstream json(jsonPath);
+        if (!json) {
+            throw InvalidFile();
+        }
+        profiler.writeJson(json);
+    }
+}
+
+// Compiled and optimized source file, with the exit check of the file mode
+static Program compileChecked(Compiler& compiler, Optimizer& optimizer, const std::string& fileName) {
+    Program program = compiler.compileFile(fileName);
+
+    if (!program.hasExit()) {
+        throw NoExitInstruction();
+    }
+    return optimizer.optimize(program);
+}
+
+static void writeSnapshot(const char* fileName, const std::string& snapshot) {
+    std::ofstream outfile(fileName, std::ios::binary | std::ios::trunc);
+
+    outfile.write(snapshot.data(), snapshot.size());
+    if (!outfile) {
+        throw InvalidFile();
+    }
+}
+
+/*
+    Usage:
+        ./my_abstract_vm                                read the program from stdin
+        ./my_abstract_vm file.avm                       compile and run a source file
+        ./my_abstract_vm file.avmc                      run a compiled file straight from its mapped pages
+        ./my_abstract_vm --compile file.avm out.avmc    compile a source file to bytecode without running it
+        ./my_abstract_vm --stream file.avm              run a source file while reading it, in a single pass
+        ./my_abstract_vm --pairs file.avm               run a source file and report its most frequent opcode pairs
+        ./my_abstract_vm --profile file.avm [out.json]  run a source file and report the count, time and stack growths
+                                                        per opcode, the hits per line and the peak stack depth,
+                                                        also as JSON in out.json
+        ./my_abstract_vm --registers file.avm           run a source file translated to registers, faster for
+                                                        loops, slower for code that runs once
+        ./my_abstract_vm --batch <dir|manifest|glob> [-j N] [--prefix-cache MB]
+                                                        run many programs on N threads (one per core by default),
+                                                        resuming the prefixes they share from a cache of MB
+        ./my_abstract_vm --checkpoint file.avm L out.avms
+                                                        run a source file up to its line L and save the state
+        ./my_abstract_vm --resume file.avm in.avms      restore the state saved for that file and run the rest
+        ./my_abstract_vm --serve <socket> [-j N] [--prefix-cache MB]
+                                                        run the programs sent on a Unix socket on N workers
+                                                        until SIGINT or SIGTERM (see include/VmServer.hpp)
+*/
 int main(int argc, char* argv[]) {
-    InstructionParser parser;
+    Compiler compiler;
+    Optimizer optimizer;
     MyAbstractVM vm;
 
     std::string line;
 
     try {
-        // File given as argument
-        if (argc > 1) {
-            std::string fileName = argv[1];
+        // Compile only
+        if (argc > 3 && std::string(argv[1]) == "--compile") {
+            Program program = compiler.compileFile(argv[2]);
 
-            std::ifstream infile(argv[1]);
-            if (!infile) {
-                throw InvalidFile();
+            if (!program.hasExit()) {
+                throw NoExitInstruction();
             }
 
-            if (!parser.hasInstructionExit(fileName)) {
-                throw NoExitInstruction();
+            BytecodeFile::write(argv[3], optimizer.optimize(program));
+        }
+        // Many programs across cores
+        else if (argc > 2 && std::string(argv[1]) == "--batch") {
+            return runBatch(argv[2], poolOptions(argc, argv, 3));
+        }
+        // Snapshot of the state after a line, the prefix is not run again on resume
+        else if (argc > 4 && std::string(argv[1]) == "--checkpoint") {
+            Program program = compileChecked(compiler, optimizer, argv[2]);
+            size_t stopLine = optionValue(argv[3], MAX_LINE);
+            size_t stop = 0;
+            size_t pc = 0;
+
+            while (stop < program.size() && program.data()[stop].line <= stopLine) {
+                stop++;
             }
 
-            while (std::getline(infile, line)) {
-                parser.processLine(line, parser, vm);
+            // a loop of the prefix may jump back, the snapshot is taken once the run gets past it
+            if (vm.run(program.data(), stop, pc) == Exited) {
+                std::cerr << "The program exited before line " << stopLine << ", no snapshot written" << std::endl;
+                return EXIT_FAILURE;
             }
+            writeSnapshot(argv[4], vm.saveState(instructionChecksum(program.data(), program.size()), pc));
+        }
+        else if (argc > 3 && std::string(argv[1]) == "--resume") {
+            Program program = compileChecked(compiler, optimizer, argv[2]);
+            MappedFile snapshot(argv[3]);
+            size_t pc = vm.restoreState(instructionChecksum(program.data(), program.size()), program.size(),
+                                         snapshot.data(), snapshot.size());
+
+            vm.run(program.data(), program.size(), pc);
+        }
+        // Persistent server, no process start per program
+        else if (argc > 2 && std::string(argv[1]) == "--serve") {
+            PoolOptions options = poolOptions(argc, argv, 3);
+            VmServer server(argv[2], options.threads);
+            PrefixCache cache(options.cacheMegabytes << 20);
+
+            if (options.cacheMegabytes > 0) {
+                server.setPrefixCache(&cache);
+            }
+            std::cerr << "Serving on " << argv[2] << " with " << server.workerCount() << " workers" << std::endl;
+            server.run();
+            if (options.cacheMegabytes > 0) {
+                reportCache(cache);
+            }
+        }
+        // Single pass over a big source file
+        else if (argc > 2 && std::string(argv[1]) == "--stream") {
+            StreamRunner runner(compiler, vm);
+            runner.runFile(argv[2]);
+        }
+        // Opcode pair frequencies, the profile data behind the fused instructions
+        else if (argc > 2 && std::string(argv[1]) == "--pairs") {
+            Program program = compileChecked(compiler, optimizer, argv[2]);
+
+            PairCounter counter;
+            vm.setPairCounter(&counter);
+            vm.run(program.data(), program.size());
+            reportPairs(counter);
+        }
+        // Register form of the program, same output and errors as the stack interpreter
+        else if (argc > 2 && std::string(argv[1]) == "--registers") {
+            Program program = compileChecked(compiler, optimizer, argv[2]);
+            RegisterTranslator translator;
+
+            vm.run(translator.translate(program));
+        }
+        // Count, time and stack growths of every opcode, hits of every line
+        else if (argc > 2 && std::string(argv[1]) == "--profile") {
+            Program program = compileChecked(compiler, optimizer, argv[2]);
+            Profiler profiler;
+
+            vm.setProfiler(&profiler);
+            try {
+                vm.run(program.data(), program.size());
+            } catch (...) {
+                // the profile up to the error is still worth reading
+                reportProfile(profiler, argc > 3 ? argv[3] : nullptr);
+                throw;
+            }
+            reportProfile(profiler, argc > 3 ? argv[3] : nullptr);
+        }
+        // Compiled file given as argument, no parsing at all
+        else if (argc > 1 && BytecodeFile::isBytecode(argv[1])) {
+            BytecodeFile bytecode(argv[1]);
+
+            if (!bytecode.hasExit()) {
+                throw NoExitInstruction();
+            }
+
+            vm.run(bytecode.data(), bytecode.size());
+        }
+        // File given as argument
+        else if (argc > 1) {
+            // the whole file is compiled first (in parallel chunks when it is big), then run without any parsing
+            Program program = compileChecked(compiler, optimizer, argv[1]);
+            vm.run(program.data(), program.size());
         } 
         // Handle standard input (stdin)
         else {
+            Program program;
+            IncrementalLinker linker;
+            uint32_t lineNumber = 0;
+            size_t pc = 0;
+            bool toEnd = false;
+
+            // each line is run as soon as it is typed, the lines are kept for the jumps back
             while (true) {
-                if (!std::getline(std::cin, line)) break;
-                parser.processLine(line, parser, vm);
+                if (!std::getline(std::cin, line)) {
+                    // a jump still waiting for its label will never get it
+                    linker.finish();
+                    if (toEnd) {
+                        vm.run(program.data(), program.size(), pc);
+                    }
+                    break;
+                }
+
+                compiler.compileLine(line, ++lineNumber, program);
+                linker.update(program);
+
+                // a jump before the first exit to a label after it: as in the whole file mode the whole input
+                // is the program, it is read to its end before the rest runs, and an invalid line fails it
+                toEnd = toEnd || linker.jumpsPastExit(program);
+                if (!toEnd && vm.run(program.data(), linker.linkedSize(program), pc) == Exited) {
+                    break;
+                }
             }
         }
     } catch (const std::exception& e) {
+        // what the program printed before the error comes first
+        vm.getOutput().flush();
         std::cerr << e.what() << std::endl;
         return EXIT_FAILURE; 
     }
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
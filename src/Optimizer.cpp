@@ -0,0 +1,137 @@
+#include "../include/Optimizer.hpp"
+#include <algorithm>
+#include <exception>
+
+Program Optimizer::optimize(const Program& program) {
+    const Instruction* source = program.data();
+    size_t count = program.size();
+    std::vector<bool> targets;
+
+    code.clear();
+    code.reserve(count);
+    position.clear();
+    carryTarget = false;
+
+    for (size_t i = 0; i < count; i++) {
+        if (isJump(source[i].opcode)) {
+            targets.resize(count + 1);
+            targets[std::min<size_t>(source[i].target(), count)] = true;
+        }
+    }
+    if (!targets.empty()) {
+        position.resize(count + 1);
+    }
+
+    // the tail of code is always fully reduced, so each new instruction only has to look behind it
+    for (size_t i = 0; i < count; i++) {
+        Instruction instruction = source[i];
+
+        if (!targets.empty()) {
+            position[i] = code.size();
+            if (targets[i] || carryTarget) {
+                instruction.flags |= JUMP_TARGET;
+                carryTarget = false;
+            }
+        }
+        code.push_back(instruction);
+        reduce();
+    }
+
+    if (!targets.empty()) {
+        position[count] = code.size();
+        for (Instruction& instruction : code) {
+            if (isJump(instruction.opcode)) {
+                instruction.setTarget(position[std::min<size_t>(instruction.target(), count)]);
+            }
+        }
+    }
+
+    Program optimized;
+    optimized.reserve(code.size());
+    for (const Instruction& instruction : code) {
+        optimized.append(instruction);
+    }
+    return optimized;
+}
+
+void Optimizer::reduce() {
+    size_t count = code.size();
+    if (count < 2) {
+        return;
+    }
+    Instruction& last = code[count - 1];
+    Instruction& previous = code[count - 2];
+
+    // a jump lands on last without running previous
+    if (last.flags & JUMP_TARGET) {
+        return;
+    }
+
+    if (last.opcode == Pop) {
+        if (previous.opcode == Push) {
+            // a jump to the push now lands on whatever comes next
+            carryTarget = previous.flags & JUMP_TARGET;
+            code.resize(count - 2);
+            _stats.removed++;
+        } else if (previous.opcode == Assert) {
+            // once the assert passed the stack is not empty, only the assert can fail
+            fuse(AssertPop, previous.line);
+        } else if (previous.opcode == Dump) {
+            // dump never fails, only the pop can
+            fuse(DumpPop, last.line);
+        }
+        return;
+    }
+
+    // push v; assert v always passes
+    if (last.opcode == Assert && previous.opcode == Push && previous.operand() == last.operand()) {
+        code.pop_back();
+        _stats.resolved++;
+        return;
+    }
+
+    if (!isArithmetic(last.opcode) || previous.opcode != Push) {
+        return;
+    }
+
+    eArithOp op = arithOp(last.opcode);
+    if (count >= 3 && code[count - 3].opcode == Push && !(previous.flags & JUMP_TARGET) && fold(op)) {
+        return;
+    }
+
+    // push v; op -> one instruction, it fails on the line of the operation like op did
+    fuse(static_cast<eInstructionType>(PushAdd + op), last.line);
+}
+
+// Merges the last two instructions into opcode, the operand of the first one is kept
+void Optimizer::fuse(eInstructionType opcode, uint32_t line) {
+    code.pop_back();
+    code.back().opcode = opcode;
+    code.back().line = line;
+    _stats.fused++;
+}
+
+// push a; push b; op -> push (b op a), unless the operation raises an error
+bool Optimizer::fold(eArithOp op) {
+    size_t count = code.size();
+    Value operand1 = code[count - 2].operand();
+    Value operand2 = code[count - 3].operand();
+    Value result;
+
+    try {
+        result = findArithKernel(operand1.type, operand2.type, op)(operand1, operand2);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    Instruction folded = code[count - 1];
+    folded.flags = code[count - 3].flags;
+    folded.opcode = Push;
+    folded.type = result.type;
+    folded.immediate = result.raw;
+
+    code.resize(count - 3);
+    code.push_back(folded);
+    _stats.folded++;
+    return true;
+}
@@ -0,0 +1,19 @@
+#include "../include/OutputSink.hpp"
+#include <errno.h>
+#include <unistd.h>
+
+void FdSink::commit(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // nowhere left to report it, the output is lost
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
@@ -0,0 +1,25 @@
+#include "../include/PairCounter.hpp"
+#include <algorithm>
+
+std::vector<PairCounter::Pair> PairCounter::top(size_t n) const {
+    std::vector<Pair> pairs;
+
+    for (size_t first = 0; first < INSTRUCTION_TYPES; first++) {
+        for (size_t second = 0; second < INSTRUCTION_TYPES; second++) {
+            if (counts[first][second]) {
+                pairs.push_back({static_cast<uint8_t>(first), static_cast<uint8_t>(second), counts[first][second]});
+            }
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.count > b.count; });
+    if (pairs.size() > n) {
+        pairs.resize(n);
+    }
+    return pairs;
+}
+
+void PairCounter::clear() {
+    std::fill(&counts[0][0], &counts[0][0] + INSTRUCTION_TYPES * INSTRUCTION_TYPES, 0);
+    last = INSTRUCTION_TYPES;
+}
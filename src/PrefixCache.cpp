@@ -0,0 +1,76 @@
+#include "../include/PrefixCache.hpp"
+
+// Cost of an entry beyond its strings: list node, hash node and the shared checkpoint
+static const size_t ENTRY_OVERHEAD = 128;
+
+PrefixCache::PrefixCache(size_t budget, size_t interval) : _budget(budget), _interval(interval > 0 ? interval : 1) {}
+
+void PrefixCache::prefixHashes(const Instruction* code, size_t count, std::vector<uint64_t>& hashes) const {
+    uint64_t hash = wordHash(nullptr, 0);
+
+    // the last checkpoint is before the last instruction, a checkpoint at the end would skip nothing
+    hashes.clear();
+    for (size_t end = _interval; end < count; end += _interval) {
+        hash = wordHash(code + end - _interval, _interval * sizeof(Instruction), hash);
+        hashes.push_back(hash);
+    }
+}
+
+std::shared_ptr<const PrefixCache::Checkpoint> PrefixCache::find(const std::vector<uint64_t>& hashes, size_t& index) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (size_t i = hashes.size(); i-- > 0; ) {
+        auto found = entries.find(hashes[i]);
+
+        if (found != entries.end()) {
+            recent.splice(recent.begin(), recent, found->second);
+            _stats.hits++;
+            _stats.skipped += (i + 1) * _interval;
+            index = i;
+            return found->second->checkpoint;
+        }
+    }
+
+    if (!hashes.empty()) {
+        _stats.misses++;
+    }
+    return nullptr;
+}
+
+bool PrefixCache::contains(uint64_t hash) {
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.count(hash) != 0;
+}
+
+void PrefixCache::store(uint64_t hash, std::string snapshot, std::string output) {
+    size_t bytes = snapshot.size() + output.size() + ENTRY_OVERHEAD;
+    std::lock_guard<std::mutex> guard(lock);
+
+    // another worker may have stored it meanwhile, and a checkpoint bigger than the budget would empty the cache
+    if (bytes > _budget || entries.count(hash)) {
+        return;
+    }
+
+    while (_stats.bytes + bytes > _budget) {
+        const Entry& oldest = recent.back();
+
+        _stats.bytes -= oldest.bytes;
+        _stats.evictions++;
+        entries.erase(oldest.hash);
+        recent.pop_back();
+    }
+
+    auto checkpoint = std::make_shared<const Checkpoint>(Checkpoint{std::move(snapshot), std::move(output)});
+    recent.push_front({hash, bytes, std::move(checkpoint)});
+    entries[hash] = recent.begin();
+    _stats.bytes += bytes;
+    _stats.stores++;
+}
+
+PrefixCache::Stats PrefixCache::stats() {
+    std::lock_guard<std::mutex> guard(lock);
+    Stats copy = _stats;
+
+    copy.entries = entries.size();
+    return copy;
+}
@@ -0,0 +1,70 @@
+#include "../include/Profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+
+void Profiler::writeTable(std::ostream& out, size_t hottestLines) const {
+    std::ios_base::fmtflags flags = out.flags();
+
+    out << std::left << std::setw(12) << "opcode" << std::right
+        << std::setw(14) << "count" << std::setw(16) << "total ns" << std::setw(12) << "avg ns"
+        << std::setw(15) << "stack growths" << std::endl;
+
+    for (size_t i = 0; i < INSTRUCTION_TYPES; i++) {
+        const OpcodeStats& stats = opcodes[i];
+        if (!stats.count) {
+            continue;
+        }
+        out << std::left << std::setw(12) << instructionName(i) << std::right
+            << std::setw(14) << stats.count << std::setw(16) << stats.nanoseconds
+            << std::setw(12) << std::fixed << std::setprecision(1) << stats.averageNanoseconds()
+            << std::setw(15) << stats.stackGrowths << std::endl;
+    }
+
+    out << "peak stack depth: " << peakDepth << std::endl;
+
+    // hottest lines first, ties in source order
+    std::vector<uint32_t> hot;
+    for (uint32_t line = 0; line < lines.size(); line++) {
+        if (lines[line]) {
+            hot.push_back(line);
+        }
+    }
+    std::stable_sort(hot.begin(), hot.end(), [this](uint32_t a, uint32_t b) { return lines[a] > lines[b]; });
+    if (hot.size() > hottestLines) {
+        hot.resize(hottestLines);
+    }
+
+    out << std::left << std::setw(12) << "line" << std::right << std::setw(14) << "hits" << std::endl;
+    for (uint32_t line : hot) {
+        out << std::left << std::setw(12) << line << std::right << std::setw(14) << lines[line] << std::endl;
+    }
+
+    out.flags(flags);
+}
+
+void Profiler::writeJson(std::ostream& out) const {
+    out << "{\n  \"opcodes\": {";
+
+    const char* separator = "\n";
+    for (size_t i = 0; i < INSTRUCTION_TYPES; i++) {
+        const OpcodeStats& stats = opcodes[i];
+        if (!stats.count) {
+            continue;
+        }
+        out << separator << "    \"" << instructionName(i) << "\": {\"count\": " << stats.count
+            << ", \"total_ns\": " << stats.nanoseconds << ", \"avg_ns\": " << stats.averageNanoseconds()
+            << ", \"stack_growths\": " << stats.stackGrowths << "}";
+        separator = ",\n";
+    }
+
+    out << "\n  },\n  \"peak_stack_depth\": " << peakDepth << ",\n  \"lines\": {";
+
+    separator = "\n";
+    for (uint32_t line = 0; line < lines.size(); line++) {
+        if (lines[line]) {
+            out << separator << "    \"" << line << "\": " << lines[line];
+            separator = ",\n";
+        }
+    }
+    out << "\n  }\n}" << std::endl;
+}
@@ -0,0 +1,250 @@
+#include "../include/MyAbstractVm.hpp"
+
+/*
+    Execution loop of the register form of a program (see RegisterProgram.hpp).
+
+    Inside a block the operands are read from the register file and the results written there,
+    the stack is only touched by Peek, and by Drop and Store when the block ends. RegEnter checks
+    that the stack holds every value the block takes: if it does not, or if anything in the block
+    throws, the stack is still the one the block started on, and the stack interpreter takes over
+    from the first instruction of the block. It raises the error on its line, or runs the rest of
+    the program if there is none.
+
+    Threaded like Interpreter.cpp with GCC/Clang, a switch loop with -DAVM_SWITCH_DISPATCH.
+*/
+#if defined(__GNUC__) && !defined(AVM_SWITCH_DISPATCH)
+    #define AVM_THREADED_DISPATCH
+#endif
+
+#ifdef AVM_THREADED_DISPATCH
+
+eRunStatus MyAbstractVM::run(const RegisterProgram& program) {
+    // handler addresses, indexed by eRegisterOp
+    static const void* const handlers[] = {
+        &&do_enter, &&do_load, &&do_peek, &&do_arith, &&do_arith_imm, &&do_assert, &&do_drop, &&do_store, &&do_push,
+        &&do_branch, &&do_dump, &&do_dump_pop, &&do_print, &&do_sum, &&do_addn, &&do_mulp, &&do_jmp, &&do_call,
+        &&do_ret, &&do_exit, &&do_end,
+    };
+    static_assert(sizeof(handlers) / sizeof(*handlers) == REGISTER_OPS, "one handler per register opcode");
+
+    const RegisterInstruction* code = program.data();
+    size_t ip = 0;
+    size_t pc = 0;      // where the stack interpreter takes over
+
+    registers.resize(program.registerCount());
+    Value* r = registers.data();
+
+    #define DISPATCH() goto *handlers[code[ip].opcode]
+    #define NEXT() do { ++ip; DISPATCH(); } while (0)
+
+    try {
+        DISPATCH();
+
+        do_enter:
+            if (stack.size() < code[ip].count) {
+                pc = code[ip].pc;
+                goto fallback;
+            }
+            NEXT();
+        do_load:
+            r[code[ip].dst] = code[ip].immediate;
+            NEXT();
+        do_peek:
+            r[code[ip].dst] = stack.fromTop(code[ip].count);
+            NEXT();
+        do_arith: {
+            const RegisterInstruction& instruction = code[ip];
+            const Value& lhs = r[instruction.lhs];
+            const Value& rhs = r[instruction.rhs];
+
+            r[instruction.dst] = findArithKernel(lhs.type, rhs.type, static_cast<eArithOp>(instruction.op))(lhs, rhs);
+            NEXT();
+        }
+        do_arith_imm: {
+            const RegisterInstruction& instruction = code[ip];
+            const Value& rhs = r[instruction.rhs];
+
+            r[instruction.dst] = findArithKernel(instruction.immediate.type, rhs.type, static_cast<eArithOp>(instruction.op))(instruction.immediate, rhs);
+            NEXT();
+        }
+        do_assert:
+            if (!(r[code[ip].lhs] == code[ip].immediate)) {
+                throw AssertError();
+            }
+            NEXT();
+        do_drop:
+            stack.pop(code[ip].count);
+            NEXT();
+        do_store:
+            stack.push(r[code[ip].lhs]);
+            NEXT();
+        do_push:
+            stack.push(code[ip].immediate);
+            NEXT();
+        do_branch:
+            ip = jumpTaken(code[ip].op, compareValues(r[code[ip].lhs], r[code[ip].rhs])) ? code[ip].count : ip + 1;
+            DISPATCH();
+        do_dump:
+            dump();
+            NEXT();
+        do_dump_pop:
+            // pop only fails on an empty stack, where dump printed nothing: the rerun prints the same
+            dump();
+            pop();
+            NEXT();
+        do_print:
+            print();
+            NEXT();
+        do_sum:
+            sum();
+            NEXT();
+        do_addn:
+            addTop(code[ip].immediate.to<int32_t>());
+            NEXT();
+        do_mulp:
+            mulPairs(code[ip].immediate.to<int32_t>());
+            NEXT();
+        do_jmp:
+            ip = code[ip].count;
+            DISPATCH();
+        do_call:
+            call(code[ip].pc + 1);
+            ip = code[ip].count;
+            DISPATCH();
+        do_ret: {
+            size_t returnTo = ret();
+            uint32_t entry = program.entry(returnTo);
+
+            // a return address pushed by another run, only the stack interpreter knows it
+            if (entry == RegisterProgram::NO_ENTRY) {
+                pc = returnTo;
+                goto fallback;
+            }
+            ip = entry;
+            DISPATCH();
+        }
+        do_exit:
+            exitProgram();
+            return Exited;
+        do_end:
+            output->flush();
+            return Completed;
+    } catch (const std::exception&) {
+        pc = code[ip].pc;
+    }
+
+    #undef DISPATCH
+    #undef NEXT
+
+fallback:
+    return run(program.stackData(), program.stackSize(), pc);
+}
+
+#else
+
+eRunStatus MyAbstractVM::run(const RegisterProgram& program) {
+    const RegisterInstruction* code = program.data();
+    size_t ip = 0;
+    size_t pc = 0;      // where the stack interpreter takes over
+
+    registers.resize(program.registerCount());
+    Value* r = registers.data();
+
+    try {
+        while (true) {
+            const RegisterInstruction& instruction = code[ip];
+
+            switch (instruction.opcode) {
+                case RegEnter:
+                    if (stack.size() < instruction.count) {
+                        pc = instruction.pc;
+                        goto fallback;
+                    }
+                    break;
+                case RegLoad:
+                    r[instruction.dst] = instruction.immediate;
+                    break;
+                case RegPeek:
+                    r[instruction.dst] = stack.fromTop(instruction.count);
+                    break;
+                case RegArith:
+                    r[instruction.dst] = findArithKernel(r[instruction.lhs].type, r[instruction.rhs].type,
+                                                         static_cast<eArithOp>(instruction.op))(r[instruction.lhs], r[instruction.rhs]);
+                    break;
+                case RegArithImm:
+                    r[instruction.dst] = findArithKernel(instruction.immediate.type, r[instruction.rhs].type,
+                                                         static_cast<eArithOp>(instruction.op))(instruction.immediate, r[instruction.rhs]);
+                    break;
+                case RegAssert:
+                    if (!(r[instruction.lhs] == instruction.immediate)) {
+                        throw AssertError();
+                    }
+                    break;
+                case RegDrop:
+                    stack.pop(instruction.count);
+                    break;
+                case RegStore:
+                    stack.push(r[instruction.lhs]);
+                    break;
+                case RegPush:
+                    stack.push(instruction.immediate);
+                    break;
+                case RegBranch:
+                    ip = jumpTaken(instruction.op, compareValues(r[instruction.lhs], r[instruction.rhs])) ? instruction.count : ip + 1;
+                    continue;
+                case RegDump:
+                    dump();
+                    break;
+                case RegDumpPop:
+                    dump();
+                    pop();
+                    break;
+                case RegPrint:
+                    print();
+                    break;
+                case RegSum:
+                    sum();
+                    break;
+                case RegAddN:
+                    addTop(instruction.immediate.to<int32_t>());
+                    break;
+                case RegMulPairs:
+                    mulPairs(instruction.immediate.to<int32_t>());
+                    break;
+                case RegJmp:
+                    ip = instruction.count;
+                    continue;
+                case RegCall:
+                    call(instruction.pc + 1);
+                    ip = instruction.count;
+                    continue;
+                case RegRet: {
+                    size_t returnTo = ret();
+                    uint32_t entry = program.entry(returnTo);
+
+                    // a return address pushed by another run, only the stack interpreter knows it
+                    if (entry == RegisterProgram::NO_ENTRY) {
+                        pc = returnTo;
+                        goto fallback;
+                    }
+                    ip = entry;
+                    continue;
+                }
+                case RegExit:
+                    exitProgram();
+                    return Exited;
+                default:
+                    output->flush();
+                    return Completed;
+            }
+            ip++;
+        }
+    } catch (const std::exception&) {
+        pc = code[ip].pc;
+    }
+
+fallback:
+    return run(program.stackData(), program.stackSize(), pc);
+}
+
+#endif
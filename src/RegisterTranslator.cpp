@@ -0,0 +1,290 @@
+#include "../include/RegisterTranslator.hpp"
+#include <algorithm>
+
+// Stack instructions that a block translates to registers, a conditional jump ends its block
+static bool isBlockInstruction(uint8_t opcode) {
+    switch (opcode) {
+        case Push: case Pop: case Assert: case AssertPop: case Dup: case Swap:
+        case Add: case Sub: case Mul: case Div: case Mod:
+        case PushAdd: case PushSub: case PushMul: case PushDiv: case PushMod:
+        case Jeq: case Jne: case Jlt: case Jle: case Jgt: case Jge:
+            return true;
+        default:
+            return false;
+    }
+}
+
+RegisterProgram RegisterTranslator::translate(const Program& program) {
+    const Instruction* code = program.data();
+    size_t count = program.size();
+
+    result = RegisterProgram();
+    result.stack = code;
+    result.stackCount = count;
+    stack = code;
+    result.entries.assign(count + 1, RegisterProgram::NO_ENTRY);
+    result.code.reserve(count + 1);
+    _stats = Stats();
+
+    // jump targets and the instructions after a jump (return addresses included) start a block
+    std::vector<bool> leaders(count + 1, false);
+    leaders[0] = true;
+    for (size_t pc = 0; pc < count; pc++) {
+        if (isJump(code[pc].opcode)) {
+            leaders[std::min<size_t>(code[pc].target(), count)] = true;
+            leaders[pc + 1] = true;
+        }
+    }
+
+    for (uint32_t pc = 0; pc < count; pc++) {
+        const Instruction& instruction = code[pc];
+
+        if (leaders[pc]) {
+            closeBlock();
+            result.entries[pc] = result.code.size();
+        }
+        if (instruction.opcode == Nil) {
+            _stats.elided++;
+        } else if (isBlockInstruction(instruction.opcode)) {
+            // an instruction takes at most three registers, the slots may each need one to be stored
+            if (open && next + slots.size() + 3 > MAX_REGISTERS) {
+                closeBlock();
+            }
+            if (!open) {
+                openBlock(pc);
+            }
+            translateBlock(instruction, pc);
+        } else {
+            closeBlock();
+            translateStack(instruction, pc);
+        }
+    }
+    closeBlock();
+    result.entries[count] = result.code.size();
+    emit(RegEnd, count);
+
+    // jumps were emitted with the stack pc of their target, every target is an entry
+    for (RegisterInstruction& instruction : result.code) {
+        if (instruction.opcode == RegJmp || instruction.opcode == RegCall || instruction.opcode == RegBranch) {
+            instruction.count = result.entries[std::min<size_t>(instruction.count, count)];
+        }
+    }
+    return std::move(result);
+}
+
+void RegisterTranslator::openBlock(uint32_t pc) {
+    enter = result.code.size();
+    start = pc;
+    open = true;
+    consumed = 0;
+    next = 0;
+    slots.clear();
+    emit(RegEnter, pc);
+}
+
+/*
+    Writes the slots back to the stack. The slots at the bottom that hold the value the stack
+    already has at their place are left there, so a block that only reads the stack writes nothing.
+*/
+void RegisterTranslator::closeBlock() {
+    if (!open) {
+        return;
+    }
+    open = false;
+
+    uint32_t needed = consumed;
+    size_t kept = 0;
+
+    while (kept < slots.size() && consumed > 0 && slots[kept].kind == OnStack && slots[kept].index == consumed - 1) {
+        kept++;
+        consumed--;
+    }
+
+    // values still on the stack are read before it is popped
+    for (size_t i = kept; i < slots.size(); i++) {
+        if (slots[i].kind == OnStack) {
+            reg(slots[i]);
+        }
+    }
+    if (consumed > 0) {
+        emit(RegDrop, start).count = consumed;
+    }
+    for (size_t i = kept; i < slots.size(); i++) {
+        if (slots[i].kind == Constant) {
+            emit(RegPush, start).immediate = stack[slots[i].index].operand();
+        } else {
+            uint16_t value = reg(slots[i]);
+            emit(RegStore, start).lhs = value;
+        }
+    }
+    _stats.stores += slots.size() - kept;
+
+    std::fill(peeked.begin(), peeked.begin() + std::min<size_t>(needed, peeked.size()), NO_REGISTER);
+    result.registers = std::max<size_t>(result.registers, next);
+
+    // a block that needs no value can not fail on the depth of the stack, the next instruction takes its index
+    if (needed == 0) {
+        result.code.erase(result.code.begin() + enter);
+    } else {
+        result.code[enter].count = needed;
+    }
+    _stats.blocks++;
+}
+
+void RegisterTranslator::translateBlock(const Instruction& instruction, uint32_t pc) {
+    Slot lhs;
+    Slot rhs;
+    uint16_t dst;
+
+    switch (instruction.opcode) {
+        case Push:
+            push(Constant, pc);
+            _stats.elided++;
+            break;
+        case Pop:
+            take();
+            _stats.elided++;
+            break;
+        case Assert:
+        case AssertPop: {
+            lhs = take();
+            uint16_t value = reg(lhs);
+
+            RegisterInstruction& check = emit(RegAssert, start);
+            check.lhs = value;
+            check.immediate = instruction.operand();
+            if (instruction.opcode == Assert) {
+                push(lhs);
+            }
+            break;
+        }
+        case Dup:
+            lhs = take();
+            push(lhs);
+            push(lhs);
+            _stats.elided++;
+            break;
+        case Swap:
+            lhs = take();
+            rhs = take();
+            push(lhs);
+            push(rhs);
+            _stats.elided++;
+            break;
+        case Add:
+        case Sub:
+        case Mul:
+        case Div:
+        case Mod:
+        case PushAdd:
+        case PushSub:
+        case PushMul:
+        case PushDiv:
+        case PushMod: {
+            // the top of the stack is the left operand, a constant one is the immediate
+            lhs = instruction.opcode >= PushAdd ? Slot{Constant, pc} : take();
+            rhs = take();
+
+            uint16_t left = lhs.kind == Constant ? 0 : reg(lhs);
+            uint16_t right = reg(rhs);
+
+            dst = allocate();
+            RegisterInstruction& arith = emit(lhs.kind == Constant ? RegArithImm : RegArith, start);
+            arith.op = instruction.opcode >= PushAdd ? instruction.opcode - PushAdd : arithOp(instruction.opcode);
+            arith.dst = dst;
+            arith.lhs = left;
+            arith.rhs = right;
+            if (lhs.kind == Constant) {
+                arith.immediate = stack[lhs.index].operand();
+            }
+            push(InRegister, dst);
+            break;
+        }
+        default: {
+            // conditional jump: its operands are compared in registers, the rest goes back to the stack
+            lhs = take();
+            rhs = take();
+            uint16_t left = reg(lhs);
+            uint16_t right = reg(rhs);
+
+            closeBlock();
+            RegisterInstruction& branch = emit(RegBranch, pc);
+            branch.op = instruction.opcode;
+            branch.lhs = left;
+            branch.rhs = right;
+            branch.count = instruction.target();
+            break;
+        }
+    }
+}
+
+void RegisterTranslator::translateStack(const Instruction& instruction, uint32_t pc) {
+    uint8_t opcode;
+
+    switch (instruction.opcode) {
+        case Dump:      opcode = RegDump; break;
+        case DumpPop:   opcode = RegDumpPop; break;
+        case Print:     opcode = RegPrint; break;
+        case Sum:       opcode = RegSum; break;
+        case AddN:      opcode = RegAddN; break;
+        case MulPairs:  opcode = RegMulPairs; break;
+        case Jmp:       opcode = RegJmp; break;
+        case Call:      opcode = RegCall; break;
+        case Ret:       opcode = RegRet; break;
+        default:        opcode = RegExit; break;
+    }
+    RegisterInstruction& out = emit(opcode, pc);
+
+    if (isJump(instruction.opcode)) {
+        out.count = instruction.target();
+    } else {
+        out.immediate = instruction.operand();
+    }
+}
+
+RegisterTranslator::Slot RegisterTranslator::take() {
+    if (slots.empty()) {
+        return {OnStack, consumed++};
+    }
+    Slot slot = slots.back();
+    slots.pop_back();
+    return slot;
+}
+
+// Register holding the value of the slot, a value still on the stack is read once per block
+uint16_t RegisterTranslator::reg(Slot slot) {
+    if (slot.kind == InRegister) {
+        return slot.index;
+    }
+    if (slot.kind == Constant) {
+        uint16_t loaded = allocate();
+        RegisterInstruction& load = emit(RegLoad, start);
+        load.dst = loaded;
+        load.immediate = stack[slot.index].operand();
+        return loaded;
+    }
+    if (peeked.size() <= slot.index) {
+        peeked.resize(slot.index + 1, NO_REGISTER);
+    }
+    if (peeked[slot.index] == NO_REGISTER) {
+        peeked[slot.index] = allocate();
+        RegisterInstruction& peek = emit(RegPeek, start);
+        peek.dst = peeked[slot.index];
+        peek.count = slot.index;
+        _stats.peeks++;
+    }
+    return peeked[slot.index];
+}
+
+/*
+    The instruction is zeroed and filled where it lies in the code. Built in a temporary with narrow
+    stores and copied with wide loads, each instruction would stall on store forwarding: that made
+    the translation slower than a run of the program.
+*/
+RegisterInstruction& RegisterTranslator::emit(uint8_t opcode, uint32_t pc) {
+    RegisterInstruction& instruction = result.code.emplace_back();
+
+    instruction.opcode = opcode;
+    instruction.pc = pc;
+    return instruction;
+}
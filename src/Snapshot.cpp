@@ -0,0 +1,144 @@
+#include "../include/MyAbstractVm.hpp"
+#include "../include/Snapshot.hpp"
+#include <stddef.h>
+
+static const char AVMS_MAGIC[4] = { 'A', 'V', 'M', 'S' };
+
+// The checksum covers the header fields before it, then the segments, the calls and the stack
+static uint64_t snapshotChecksum(const SnapshotHeader& header, const char* payload, size_t size) {
+    return wordHash(payload, size, wordHash(&header, offsetof(SnapshotHeader, checksum)));
+}
+
+std::string MyAbstractVM::saveState(uint64_t program, size_t pc) const {
+    const std::vector<ValueStack::Segment>& table = stack.segmentTable();
+    SnapshotHeader header = {};
+
+    memcpy(header.magic, AVMS_MAGIC, sizeof(AVMS_MAGIC));
+    header.version = AVMS_VERSION;
+    header.segmentSize = sizeof(SnapshotSegment);
+    header.segmentCount = table.size();
+    header.callCount = calls.size();
+    header.program = program;
+    header.pc = pc;
+    header.outputPosition = output->position();
+    header.valueCount = stack.size();
+    header.stackBytes = stack.bytesUsed();
+
+    size_t callsOffset = table.size() * sizeof(SnapshotSegment);
+    size_t stackOffset = callsOffset + calls.size() * sizeof(uint32_t);
+    std::string snapshot(sizeof(header) + stackOffset + header.stackBytes, '\0');
+    char* payload = &snapshot[sizeof(header)];
+
+    for (size_t i = 0; i < table.size(); i++) {
+        SnapshotSegment segment = {};
+
+        segment.type = table[i].type;
+        segment.first = table[i].first;
+        segment.offset = table[i].offset;
+        memcpy(payload + i * sizeof(segment), &segment, sizeof(segment));
+    }
+    if (!calls.empty()) {
+        memcpy(payload + callsOffset, calls.data(), calls.size() * sizeof(uint32_t));
+    }
+    if (header.stackBytes > 0) {
+        memcpy(payload + stackOffset, stack.data(), header.stackBytes);
+    }
+
+    header.checksum = snapshotChecksum(header, payload, snapshot.size() - sizeof(header));
+    memcpy(&snapshot[0], &header, sizeof(header));
+    return snapshot;
+}
+
+/*
+    The stack block is copied as it is, so the table must describe exactly what ValueStack would
+    have built: segments in order from value 0, no two neighbours of one type, offsets aligned for
+    their type and past the values of the previous segment, and stackBytes ending with the last value.
+*/
+static bool validSegments(const std::vector<ValueStack::Segment>& table, uint64_t values, uint64_t stackBytes) {
+    if (table.empty()) {
+        return values == 0 && stackBytes == 0;
+    }
+    if (table[0].first != 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < table.size(); i++) {
+        const ValueStack::Segment& segment = table[i];
+        size_t size = ValueStack::SIZES[segment.type];
+        uint64_t end = i + 1 < table.size() ? table[i + 1].first : values;
+
+        if (end <= segment.first || segment.offset % size != 0
+            || (i + 1 < table.size() && table[i + 1].type == segment.type)) {
+            return false;
+        }
+        // segment.offset <= stackBytes first, so that the product below cannot wrap around
+        if (segment.offset > stackBytes || (end - segment.first) > (stackBytes - segment.offset) / size) {
+            return false;
+        }
+
+        uint64_t limit = segment.offset + (end - segment.first) * size;
+        if (i + 1 < table.size() ? table[i + 1].offset < limit : limit != stackBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t MyAbstractVM::restoreState(uint64_t program, size_t count, const char* data, size_t size) {
+    SnapshotHeader header;
+
+    if (size < sizeof(header)) {
+        throw InvalidSnapshot();
+    }
+    memcpy(&header, data, sizeof(header));
+
+    const char* payload = data + sizeof(header);
+    size_t payloadSize = size - sizeof(header);
+
+    if (memcmp(header.magic, AVMS_MAGIC, sizeof(AVMS_MAGIC)) != 0
+        || header.version != AVMS_VERSION
+        || header.segmentSize != sizeof(SnapshotSegment)
+        || header.segmentCount > payloadSize / sizeof(SnapshotSegment)
+        || header.callCount > MAX_CALL_DEPTH
+        || header.segmentCount * sizeof(SnapshotSegment) + header.callCount * sizeof(uint32_t) > payloadSize
+        || header.stackBytes != payloadSize - header.segmentCount * sizeof(SnapshotSegment) - header.callCount * sizeof(uint32_t)
+        || header.checksum != snapshotChecksum(header, payload, payloadSize)) {
+        throw InvalidSnapshot();
+    }
+    if (header.program != program || header.pc > count) {
+        throw InvalidSnapshot();
+    }
+
+    // one entry per segment, the values themselves are never looked at one by one
+    std::vector<ValueStack::Segment> table(header.segmentCount);
+    for (size_t i = 0; i < table.size(); i++) {
+        SnapshotSegment segment;
+
+        memcpy(&segment, payload + i * sizeof(segment), sizeof(segment));
+        if (segment.type > Double) {
+            throw InvalidSnapshot();
+        }
+        table[i] = {static_cast<eOperandType>(segment.type), static_cast<size_t>(segment.first), static_cast<size_t>(segment.offset)};
+    }
+    if (!validSegments(table, header.valueCount, header.stackBytes)) {
+        throw InvalidSnapshot();
+    }
+
+    // a return address is an instruction of the program, or its end
+    const char* callData = payload + header.segmentCount * sizeof(SnapshotSegment);
+    std::vector<uint32_t> returns(header.callCount);
+
+    if (!returns.empty()) {
+        memcpy(returns.data(), callData, returns.size() * sizeof(uint32_t));
+    }
+    for (uint32_t returnTo : returns) {
+        if (returnTo > count) {
+            throw InvalidSnapshot();
+        }
+    }
+
+    stack.assign(table, header.valueCount, callData + returns.size() * sizeof(uint32_t), header.stackBytes);
+    calls.swap(returns);
+    output->setPosition(header.outputPosition);
+    return header.pc;
+}
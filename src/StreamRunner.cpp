@@ -0,0 +1,134 @@
+#include "../include/StreamRunner.hpp"
+#include "../include/MappedFile.hpp"
+#include <string.h>
+
+// Same rule as the exit check of the whole file mode: a line the compiler reads as exit, labeled or not, or ';;'
+bool StreamRunner::isExitLine(const char* begin, const char* end) {
+    try {
+        return tokenizeLine(std::string_view(begin, end - begin)).instruction == Exit;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void StreamRunner::releaseOutput() {
+    vm.resetOutput();
+    vm.getOutput().write(held.str());
+    held.clear();
+}
+
+void StreamRunner::runBatch(Program& batch, bool last) {
+    runCompiled(batch, last);
+    if (batch.labels().empty() && batch.jumps().empty()) {
+        batch.clear();
+    }
+}
+
+/*
+    Straight-line instructions are only optimized inside their batch, a push and its operation may
+    end up in two batches. Kept batches run from pc up to their first jump without a target, the
+    last run links them whole so that a jump to an undefined label fails.
+*/
+void StreamRunner::runCompiled(Program& batch, bool last) {
+    bool straight = batch.labels().empty() && batch.jumps().empty();
+
+    if (!straight) {
+        compiler.link(batch, !last);
+    }
+
+    // once exit is compiled and linked the program is known to be valid, its output can be released
+    if (batch.hasExit() && !exitSeen) {
+        exitSeen = true;
+        releaseOutput();
+    }
+
+    if (straight) {
+        Program optimized = optimizer.optimize(batch);
+        exited = vm.run(optimized.data(), optimized.size()) == Exited;
+        return;
+    }
+
+    ran = batch.size();
+    exited = vm.run(batch.data(), batch.linkedSize(), pc) == Exited;
+}
+
+void StreamRunner::runFile(const std::string& fileName) {
+    MappedFile file(fileName);
+
+    const char* cursor = file.data();
+    const char* end = cursor + file.size();
+    uint32_t lineNumber = 0;
+    Program batch;
+
+    vm.setOutput(held);
+
+    try {
+        while (cursor < end && !exited) {
+            const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+            const char* lineEnd = newline ? newline : end;
+
+            try {
+                compiler.compileLine(std::string_view(cursor, lineEnd - cursor), ++lineNumber, batch);
+            } catch (const std::exception& e) {
+                cursor = newline ? newline + 1 : end;
+                if (toEnd) {
+                    throw;
+                }
+                // the lines before the invalid one run first, one of their errors comes first,
+                // and with jumps they may exit before the invalid line is reached
+                runCompiled(batch, false);
+                if (!exited) {
+                    throw;
+                }
+                break;
+            }
+            cursor = newline ? newline + 1 : end;
+
+            // what follows the first exit can only run if a jump before it leads there,
+            // then the rest of the file is compiled before the batch of the exit runs
+            if (batch.hasExit() && !toEnd) {
+                if (!Compiler::jumpsPastExit(batch)) {
+                    break;
+                }
+                toEnd = true;
+            }
+
+            if (!toEnd && batch.size() - ran >= BATCH_SIZE) {
+                runBatch(batch);
+            }
+        }
+
+        if (batch.hasExit() && !exited) {
+            runBatch(batch, true);
+        }
+    } catch (const std::exception& e) {
+        // nothing ran since the exit of a whole file program was compiled: as in the whole file mode,
+        // an invalid line or label after it fails the program without output
+        if (toEnd && !exitSeen) {
+            held.clear();
+            exitSeen = true;
+        }
+
+        // look for an exit after the failing line, without running anything
+        while (!exitSeen && cursor < end) {
+            const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+            const char* lineEnd = newline ? newline : end;
+
+            exitSeen = isExitLine(cursor, lineEnd);
+            cursor = newline ? newline + 1 : end;
+        }
+
+        if (!exitSeen) {
+            vm.resetOutput();
+            throw NoExitInstruction();
+        }
+        releaseOutput();
+        throw;
+    }
+
+    vm.resetOutput();
+
+    if (!exitSeen) {
+        throw NoExitInstruction();
+    }
+}
@@ -0,0 +1,192 @@
+#include "../include/VectorKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define AVM_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+// Lanes of the floating point sums, shared by every implementation so they all round the same way
+static const size_t LANES = 4;
+
+static void addTail(double lanes[LANES], const double* values, size_t start, size_t count) {
+    for (size_t i = start; i < count; i++) {
+        lanes[(i - start) % LANES] += values[i];
+    }
+}
+
+static double combineLanes(const double lanes[LANES]) {
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+static void summarizeTail(IntSummary& summary, const int32_t* values, size_t start, size_t count) {
+    for (size_t i = start; i < count; i++) {
+        summary.sum += values[i];
+        summary.negative += values[i] < 0 ? values[i] : 0;
+    }
+}
+
+// Scalar
+
+static IntSummary sumInt32Scalar(const int32_t* values, size_t count) {
+    IntSummary summary = {0, 0};
+    summarizeTail(summary, values, 0, count);
+    return summary;
+}
+
+static double sumDoubleScalar(const double* values, size_t count) {
+    double lanes[LANES] = {0, 0, 0, 0};
+    size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t lane = 0; lane < LANES; lane++) {
+            lanes[lane] += values[i + lane];
+        }
+    }
+    addTail(lanes, values, i, count);
+    return combineLanes(lanes);
+}
+
+static void mulDoubleScalar(const double* lhs, const double* rhs, double* result, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = lhs[i] * rhs[i];
+    }
+}
+
+#ifdef AVM_X86_KERNELS
+
+// SSE4.1, two registers of two lanes stand for the four lanes
+
+__attribute__((target("sse4.1")))
+static IntSummary sumInt32Sse41(const int32_t* values, size_t count) {
+    __m128i sum = _mm_setzero_si128();
+    __m128i negative = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i below = _mm_min_epi32(block, _mm_setzero_si128());
+        sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(block));
+        sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_srli_si128(block, 8)));
+        negative = _mm_add_epi64(negative, _mm_cvtepi32_epi64(below));
+        negative = _mm_add_epi64(negative, _mm_cvtepi32_epi64(_mm_srli_si128(below, 8)));
+    }
+
+    int64_t sums[2], negatives[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), sum);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(negatives), negative);
+
+    IntSummary summary = {sums[0] + sums[1], negatives[0] + negatives[1]};
+    summarizeTail(summary, values, i, count);
+    return summary;
+}
+
+__attribute__((target("sse4.1")))
+static double sumDoubleSse41(const double* values, size_t count) {
+    __m128d low = _mm_setzero_pd();
+    __m128d high = _mm_setzero_pd();
+    size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        low = _mm_add_pd(low, _mm_loadu_pd(values + i));
+        high = _mm_add_pd(high, _mm_loadu_pd(values + i + 2));
+    }
+
+    double lanes[LANES];
+    _mm_storeu_pd(lanes, low);
+    _mm_storeu_pd(lanes + 2, high);
+    addTail(lanes, values, i, count);
+    return combineLanes(lanes);
+}
+
+__attribute__((target("sse4.1")))
+static void mulDoubleSse41(const double* lhs, const double* rhs, double* result, size_t count) {
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        _mm_storeu_pd(result + i, _mm_mul_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+    }
+    mulDoubleScalar(lhs + i, rhs + i, result + i, count - i);
+}
+
+// AVX2
+
+__attribute__((target("avx2")))
+static IntSummary sumInt32Avx2(const int32_t* values, size_t count) {
+    __m256i sum = _mm256_setzero_si256();
+    __m256i negative = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i below = _mm256_min_epi32(block, _mm256_setzero_si256());
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(block)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(block, 1)));
+        negative = _mm256_add_epi64(negative, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(below)));
+        negative = _mm256_add_epi64(negative, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(below, 1)));
+    }
+
+    int64_t sums[4], negatives[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), sum);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(negatives), negative);
+
+    IntSummary summary = {sums[0] + sums[1] + sums[2] + sums[3], negatives[0] + negatives[1] + negatives[2] + negatives[3]};
+    summarizeTail(summary, values, i, count);
+    return summary;
+}
+
+__attribute__((target("avx2")))
+static double sumDoubleAvx2(const double* values, size_t count) {
+    __m256d sum = _mm256_setzero_pd();
+    size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(values + i));
+    }
+
+    double lanes[LANES];
+    _mm256_storeu_pd(lanes, sum);
+    addTail(lanes, values, i, count);
+    return combineLanes(lanes);
+}
+
+__attribute__((target("avx2")))
+static void mulDoubleAvx2(const double* lhs, const double* rhs, double* result, size_t count) {
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+    }
+    mulDoubleScalar(lhs + i, rhs + i, result + i, count - i);
+}
+
+#endif
+
+static const VectorKernels KERNELS[] = {
+    {VectorKernels::Scalar, "scalar", sumInt32Scalar, sumDoubleScalar, mulDoubleScalar},
+#ifdef AVM_X86_KERNELS
+    {VectorKernels::Sse41, "sse4.1", sumInt32Sse41, sumDoubleSse41, mulDoubleSse41},
+    {VectorKernels::Avx2, "avx2", sumInt32Avx2, sumDoubleAvx2, mulDoubleAvx2},
+#endif
+};
+
+VectorKernels::eLevel VectorKernels::supportedLevel() {
+#ifdef AVM_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Sse41;
+    }
+#endif
+    return Scalar;
+}
+
+const VectorKernels& VectorKernels::forLevel(eLevel level) {
+    eLevel supported = supportedLevel();
+    return KERNELS[level < supported ? level : supported];
+}
+
+const VectorKernels& VectorKernels::best() {
+    static const VectorKernels& kernels = forLevel(Avx2);
+    return kernels;
+}
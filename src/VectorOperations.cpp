@@ -0,0 +1,181 @@
+#include "../include/MyAbstractVm.hpp"
+#include <type_traits>
+
+/*
+    Vector instructions. When every value of the region has the same type, the values are handed
+    as a native array to the kernels of the CPU (VectorKernels). A region of mixed types
+    is computed value by value with the arithmetic kernels, exactly like the chain of add or mul
+    it stands for, promotions and overflow checks included.
+
+    Integer results follow the rules of Int8/Int16/Int32: every partial sum of the chain lies between
+    the sum of the negative values and the sum of the positive ones. When both fit the type no step
+    of the chain overflows and the kernel total is the result, when the values all share a sign the
+    chain overflows exactly when its total does. Only a region of mixed signs whose positive or
+    negative values alone go past the range is summed again as a chain, the one case where the
+    order of the additions decides whether it overflows. Floating point sums of one type are computed in double precision with the
+    fixed lane order of VectorKernels over the values from the bottom up, then rounded to the type:
+    the same result on every CPU.
+
+    A region of one type lies in one segment of the stack (see ValueStack): int32 and double values
+    go to the kernels without any copy, the other types are converted first.
+*/
+
+/*
+    stack[first, first + count), all of one type, as an array of T: the values are read in place
+    from their segment when they already are T, otherwise they are converted into buffer
+*/
+template <eOperandType Type, typename T>
+static const T* arrayAs(const ValueStack& stack, size_t first, size_t count, std::vector<T>& buffer) {
+    using Native = typename OperandTraits<Type>::type;
+    const Native* values = stack.native<Native>(first, count, Type);
+
+    if constexpr (std::is_same<Native, T>::value) {
+        return values;
+    } else {
+        buffer.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            buffer[i] = static_cast<T>(values[i]);
+        }
+        return buffer.data();
+    }
+}
+
+template <typename T>
+static const T* arrayOf(const ValueStack& stack, size_t first, size_t count, std::vector<T>& buffer) {
+    switch (stack.segmentOf(first).type) {
+        case Int8:   return arrayAs<Int8>(stack, first, count, buffer);
+        case Int16:  return arrayAs<Int16>(stack, first, count, buffer);
+        case Int32:  return arrayAs<Int32>(stack, first, count, buffer);
+        case Float:  return arrayAs<Float>(stack, first, count, buffer);
+        default:     return arrayAs<Double>(stack, first, count, buffer);
+    }
+}
+
+static bool fitsIntegerRange(long long value, eOperandType type) {
+    long long min = (type == Int8) ? std::numeric_limits<int8_t>::min()
+                  : (type == Int16) ? std::numeric_limits<int16_t>::min() : std::numeric_limits<int32_t>::min();
+    long long max = (type == Int8) ? std::numeric_limits<int8_t>::max()
+                  : (type == Int16) ? std::numeric_limits<int16_t>::max() : std::numeric_limits<int32_t>::max();
+
+    return min <= value && value <= max;
+}
+
+static void checkIntegerRange(long long value, eOperandType type) {
+    if (!fitsIntegerRange(value, type)) {
+        throw Overflow();
+    }
+}
+
+// A double result rounded to the floating point type, Overflow if it does not fit
+static Value floatingResult(double value, eOperandType type) {
+    static_assert(std::numeric_limits<float>::is_iec559, "a double beyond the float range must round to infinity");
+
+    if (type == Float) {
+        float rounded = static_cast<float>(value);
+
+        if (!std::isfinite(rounded)) {
+            throw Overflow();
+        }
+        return Value::make<Float>(rounded);
+    }
+    if (!std::isfinite(value)) {
+        throw Overflow();
+    }
+    return Value::make<Double>(value);
+}
+
+void MyAbstractVM::sum() {
+    if (stack.empty()) {
+        throw EmptyStack();
+    }
+    addTop(stack.size());
+}
+
+void MyAbstractVM::addTop(size_t count) {
+    if (count == 0 || stack.size() < count) {
+        throw NotEnoughValues();
+    }
+
+    size_t first = stack.size() - count;
+    Value result = stack.isHomogeneous(first, count) ? vectorSum(first, count) : chainSum(first, count);
+
+    stack.pop(count - 1);
+    stack.replaceTop(result);
+}
+
+// top + second, then + third...: what a chain of add computes, reading the segments in place
+Value MyAbstractVM::chainSum(size_t first, size_t count) const {
+    Value result = stack.fromTop(0);
+
+    stack.forEachDown(first, first + count - 1, [&result](const Value& value) {
+        result = findArithKernel(result.type, value.type, OpAdd)(result, value);
+    });
+    return result;
+}
+
+Value MyAbstractVM::vectorSum(size_t first, size_t count) {
+    eOperandType type = stack.segmentOf(first).type;
+
+    if (type == Float || type == Double) {
+        return floatingResult(vector->sumDouble(arrayOf(stack, first, count, scratch.lhs), count), type);
+    }
+
+    IntSummary summary = vector->sumInt32(arrayOf(stack, first, count, scratch.ints), count);
+    if (summary.negative < 0 && summary.positive() > 0
+        && !(fitsIntegerRange(summary.negative, type) && fitsIntegerRange(summary.positive(), type))) {
+        return chainSum(first, count);
+    }
+
+    checkIntegerRange(summary.sum, type);
+    return convertValue(Value::make<Int32>(static_cast<int32_t>(summary.sum)), type);
+}
+
+void MyAbstractVM::mulPairs(size_t count) {
+    if (count == 0 || stack.size() < 2 * count) {
+        throw NotEnoughValues();
+    }
+
+    // the lower operands are stack[first...], the upper ones stack[first + count...]
+    size_t first = stack.size() - 2 * count;
+
+    if (stack.isHomogeneous(first, 2 * count)) {
+        vectorProducts(first, count);
+    } else {
+        scratch.values.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            Value operand1 = stack[first + count + i];
+            Value operand2 = stack[first + i];
+            scratch.values[i] = findArithKernel(operand1.type, operand2.type, OpMul)(operand1, operand2);
+        }
+    }
+
+    // the stack is only changed once every product succeeded
+    stack.pop(2 * count);
+    for (size_t i = 0; i < count; i++) {
+        stack.push(scratch.values[i]);
+    }
+}
+
+/*
+    Products of two values of one type, computed in double: exact for every integer type up to the
+    int32 range and for float. Above 2^53 an int32 product is rounded, but never across the int32
+    bounds, so the range check still sees every overflow.
+*/
+void MyAbstractVM::vectorProducts(size_t first, size_t count) {
+    eOperandType type = stack.segmentOf(first).type;
+
+    scratch.result.resize(count);
+    scratch.values.resize(count);
+
+    vector->mulDouble(arrayOf(stack, first + count, count, scratch.lhs), arrayOf(stack, first, count, scratch.rhs),
+                      scratch.result.data(), count);
+
+    for (size_t i = 0; i < count; i++) {
+        if (type == Float || type == Double) {
+            scratch.values[i] = floatingResult(scratch.result[i], type);
+        } else {
+            checkIntegerRange(static_cast<long long>(scratch.result[i]), type);
+            scratch.values[i] = convertValue(Value::make<Int32>(static_cast<int32_t>(scratch.result[i])), type);
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#include "../include/VmInstance.hpp"
+
+VmInstance::VmInstance(size_t stackCapacity) : vm(stackCapacity) {
+    vm.setOutput(capturedOutput);
+}
+
+void VmInstance::loadSource(const std::string& source) {
+    program = optimizer.optimize(compiler.compileBuffer(source, 1));
+    bytecode.reset();
+    next = 0;
+}
+
+void VmInstance::loadFile(const std::string& fileName) {
+    if (BytecodeFile::isBytecode(fileName)) {
+        bytecode.reset(new BytecodeFile(fileName));
+        program.clear();
+        next = 0;
+        return;
+    }
+
+    program = optimizer.optimize(compiler.compileFile(fileName, 1));
+    bytecode.reset();
+    next = 0;
+}
+
+void VmInstance::loadProgram(const Program& loaded) {
+    program = loaded;
+    bytecode.reset();
+    next = 0;
+}
+
+RunResult VmInstance::run() {
+    return execute(codeSize(), true);
+}
+
+RunResult VmInstance::runTo(size_t pc) {
+    return execute(std::max(next, std::min(pc, codeSize())), false);
+}
+
+// Runs from next until an instruction at stop or beyond is reached, the following run() starts there
+RunResult VmInstance::execute(size_t stop, bool exitRequired) {
+    RunResult result;
+    bool hasExit = bytecode ? bytecode->hasExit() : program.hasExit();
+    size_t pc = next;
+
+    next = 0;
+    try {
+        if (exitRequired && !hasExit) {
+            throw NoExitInstruction();
+        }
+        bool fresh = pc == 0 && stack().empty() && vm.callDepth() == 0 && capturedOutput.position() == 0;
+
+        if (prefixCache && exitRequired && fresh) {
+            result.status = runCached(pc);
+        } else {
+            result.status = vm.run(code(), stop, pc);
+        }
+    } catch (const ProgramError& e) {
+        result.status = Failed;
+        result.error = e.what();
+        result.errorLine = e.line();
+    } catch (const std::exception& e) {
+        result.status = Failed;
+        result.error = e.what();
+    }
+
+    if (result.status == Completed && pc < codeSize()) {
+        next = pc;
+    }
+    return result;
+}
+
+/*
+    The whole program from an empty state: resumes from the deepest checkpoint it shares with the
+    cache, then runs to the end and stores the checkpoints at 0, 1, 3, 7... checkpoints from the last
+    one. Programs that share a prefix mostly part near their end, and saving the stack at only
+    log2(n) of the n checkpoints keeps a deep stack from being copied over and over.
+
+    With jumps, the checkpoint of a prefix is the state when the run first leaves it, which only
+    depends on the prefix: its pc may be further than the end of the prefix.
+*/
+eRunStatus VmInstance::runCached(size_t& pc) {
+    const Instruction* code = this->code();
+    size_t count = codeSize();
+    size_t interval = prefixCache->interval();
+    size_t index = 0;
+
+    prefixCache->prefixHashes(code, count, prefixHashes);
+
+    if (std::shared_ptr<const PrefixCache::Checkpoint> found = prefixCache->find(prefixHashes, index)) {
+        capturedOutput.write(found->output);
+        pc = vm.restoreState(prefixHashes[index], count, found->snapshot.data(), found->snapshot.size());
+        index++;
+    }
+
+    for (; index < prefixHashes.size(); index++) {
+        size_t end = (index + 1) * interval;
+        size_t fromLast = prefixHashes.size() - 1 - index;
+
+        if ((fromLast & (fromLast + 1)) != 0) {
+            continue;
+        }
+        if (pc < end && vm.run(code, end, pc) == Exited) {
+            return Exited;
+        }
+        if (!prefixCache->contains(prefixHashes[index])) {
+            prefixCache->store(prefixHashes[index], vm.saveState(prefixHashes[index], pc), capturedOutput.str());
+        }
+    }
+
+    return vm.run(code, count, pc);
+}
+
+std::string VmInstance::checkpoint() const {
+    return vm.saveState(instructionChecksum(code(), codeSize()), next);
+}
+
+void VmInstance::restore(const char* data, size_t size) {
+    next = vm.restoreState(instructionChecksum(code(), codeSize()), codeSize(), data, size);
+
+    // the output before the checkpoint belongs to the run that took it
+    capturedOutput.clear();
+}
+
+void VmInstance::restoreFile(const std::string& fileName) {
+    MappedFile file(fileName);
+    restore(file.data(), file.size());
+}
+
+void VmInstance::reset() {
+    vm.reset();
+    capturedOutput.clear();
+    capturedOutput.setPosition(0);
+    next = 0;
+}
@@ -0,0 +1,577 @@
+#include "../include/VmServer.hpp"
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// epoll ids of the server's own descriptors, connections are numbered after them
+static const uint64_t LISTEN_ID = 0;
+static const uint64_t WAKE_ID = 1;
+static const uint64_t SIGNAL_ID = 2;
+
+static const size_t MAX_EVENTS = 64;
+static const size_t READ_CHUNK = 64 * 1024;
+
+static sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address = {};
+
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw SocketError();
+    }
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+static void watch(int epollFd, int operation, int fd, uint64_t id, uint32_t events) {
+    epoll_event event = {};
+
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(epollFd, operation, fd, &event) < 0) {
+        throw SocketError();
+    }
+}
+
+VmServer::VmServer(const std::string& socketPath, size_t workers, size_t queueLimit)
+    : socketPath(socketPath), workers(workers), queueLimit(queueLimit), nextConnection(SIGNAL_ID + 1) {
+    if (this->workers == 0) {
+        this->workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->queueLimit == 0) {
+        this->queueLimit = 4 * this->workers;
+    }
+
+    // created here so that stop() works even before run()
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        throw SocketError();
+    }
+}
+
+VmServer::~VmServer() {
+    closeAll();
+    ::close(wakeFd);
+}
+
+void VmServer::stop() {
+    uint64_t one = 1;
+
+    stopRequested = true;
+    ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    (void)written;  // a full counter still wakes the loop
+}
+
+void VmServer::run() {
+    sigset_t signals, previous;
+
+    // SIGINT and SIGTERM become events of the loop, the workers started below inherit the mask
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &previous);
+
+    try {
+        signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (signalFd < 0) {
+            throw SocketError();
+        }
+        openSocket();
+
+        stopping = false;
+        for (size_t i = 0; i < workers; i++) {
+            pool.emplace_back(&VmServer::work, this);
+        }
+
+        epoll_event events[MAX_EVENTS];
+        while (!stopRequested) {
+            int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw SocketError();
+            }
+
+            for (int i = 0; i < ready; i++) {
+                uint64_t id = events[i].data.u64;
+
+                if (id == LISTEN_ID) {
+                    acceptConnections();
+                } else if (id == WAKE_ID) {
+                    uint64_t count;
+                    ssize_t got = ::read(wakeFd, &count, sizeof(count));
+                    (void)got;
+                    collect();
+                } else if (id == SIGNAL_ID) {
+                    signalfd_siginfo info;
+                    while (::read(signalFd, &info, sizeof(info)) == sizeof(info)) {
+                        stopRequested = true;
+                    }
+                } else {
+                    auto it = connections.find(id);
+
+                    // closed earlier in this batch of events
+                    if (it == connections.end()) {
+                        continue;
+                    }
+                    if (events[i].events & EPOLLERR) {
+                        closeConnection(id);
+                        continue;
+                    }
+                    // nothing more is read, the replies of the requests already received are still sent
+                    if (events[i].events & EPOLLHUP) {
+                        hangUp(id, it->second);
+                        continue;
+                    }
+                    if (events[i].events & EPOLLOUT) {
+                        transmit(id, it->second);
+                        it = connections.find(id);
+                    }
+                    if (it != connections.end() && (events[i].events & EPOLLIN)) {
+                        receive(id, it->second);
+                    }
+                }
+            }
+        }
+    } catch (...) {
+        closeAll();
+        stopRequested = false;
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        throw;
+    }
+
+    // the next run() serves until its own stop
+    closeAll();
+    stopRequested = false;
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+}
+
+void VmServer::openSocket() {
+    sockaddr_un address = socketAddress(socketPath);
+    struct stat info;
+
+    // a socket file left by a server that did not stop cleanly is replaced, a live server is not
+    if (lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (live) {
+            throw SocketError();
+        }
+        unlink(socketPath.c_str());
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0
+        || ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || ::listen(listenFd, SOMAXCONN) < 0) {
+        throw SocketError();
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        throw SocketError();
+    }
+    watch(epollFd, EPOLL_CTL_ADD, listenFd, LISTEN_ID, EPOLLIN);
+    watch(epollFd, EPOLL_CTL_ADD, wakeFd, WAKE_ID, EPOLLIN);
+    watch(epollFd, EPOLL_CTL_ADD, signalFd, SIGNAL_ID, EPOLLIN);
+}
+
+// Stops the workers, then closes every connection and descriptor of run(), wakeFd excepted
+void VmServer::closeAll() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+        jobs.clear();
+    }
+    ready.notify_all();
+    for (std::thread& worker : pool) {
+        worker.join();
+    }
+    pool.clear();
+    finished.clear();
+
+    for (auto& entry : connections) {
+        ::close(entry.second.fd);
+    }
+    connections.clear();
+    waiting.clear();
+
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+        listenFd = -1;
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+    if (signalFd >= 0) {
+        ::close(signalFd);
+        signalFd = -1;
+    }
+}
+
+void VmServer::work() {
+    VmInstance vm;
+
+    vm.setPrefixCache(prefixCache);
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this] { return stopping || !jobs.empty(); });
+
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        std::string reply = execute(vm, job.source);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished.push_back({job.connection, std::move(reply)});
+        }
+
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+// Runs one program on the worker's instance and encodes its reply, the instance is left reset
+std::string VmServer::execute(VmInstance& vm, const std::string& source) {
+    RunResult result;
+
+    try {
+        vm.loadSource(source);
+        result = vm.run();
+    } catch (const ProgramError& e) {
+        result.status = Failed;
+        result.error = e.what();
+        result.errorLine = e.line();
+    } catch (const std::exception& e) {
+        result.status = Failed;
+        result.error = e.what();
+    }
+
+    std::string stack;
+    char buffer[32];
+    vm.stack().forEachFromTop([&stack, &buffer](const Value& value) {
+        stack.append(buffer, value.format(buffer, sizeof(buffer)));
+        stack += '\n';
+    });
+
+    const std::string& output = vm.output();
+    ReplyHeader header = {
+        static_cast<uint32_t>(result.status), static_cast<uint32_t>(result.errorLine),
+        static_cast<uint32_t>(output.size()), static_cast<uint32_t>(stack.size()), static_cast<uint32_t>(result.error.size()),
+    };
+
+    std::string reply;
+    reply.reserve(sizeof(header) + output.size() + stack.size() + result.error.size());
+    reply.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    reply += output;
+    reply += stack;
+    reply += result.error;
+
+    vm.reset();
+    return reply;
+}
+
+bool VmServer::hasRequest(const Connection& connection) {
+    RequestHeader header;
+
+    if (connection.input.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, connection.input.data(), sizeof(header));
+    return connection.input.size() - sizeof(header) >= header.sourceSize;
+}
+
+void VmServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN once the backlog is empty, EMFILE and the like leave the others in the backlog
+            return;
+        }
+
+        uint64_t id = nextConnection++;
+        Connection& connection = connections[id];
+
+        connection.fd = fd;
+        connection.events = EPOLLIN;
+        watch(epollFd, EPOLL_CTL_ADD, fd, id, EPOLLIN);
+    }
+}
+
+void VmServer::receive(uint64_t id, Connection& connection) {
+    char buffer[READ_CHUNK];
+
+    // reads until a whole request is buffered, the next ones stay in the socket: that is the backpressure
+    while (!hasRequest(connection)) {
+        ssize_t got = ::read(connection.fd, buffer, sizeof(buffer));
+
+        if (got > 0) {
+            connection.input.append(buffer, got);
+
+            RequestHeader header;
+            if (connection.input.size() >= sizeof(header)) {
+                memcpy(&header, connection.input.data(), sizeof(header));
+                if (header.sourceSize > MAX_SOURCE_SIZE) {
+                    closeConnection(id);
+                    return;
+                }
+            }
+        } else if (got == 0) {
+            connection.peerClosed = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            closeConnection(id);
+            return;
+        }
+    }
+    update(id, connection);
+}
+
+void VmServer::transmit(uint64_t id, Connection& connection) {
+    while (connection.sent < connection.unsent.size()) {
+        ssize_t written = ::send(connection.fd, connection.unsent.data() + connection.sent,
+                                 connection.unsent.size() - connection.sent, MSG_NOSIGNAL);
+
+        if (written > 0) {
+            connection.sent += written;
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            closeConnection(id);
+            return;
+        }
+    }
+
+    if (connection.sent == connection.unsent.size()) {
+        connection.unsent.clear();
+        connection.sent = 0;
+    }
+    update(id, connection);
+}
+
+// Replies of the workers go to their connections, then the freed room of the queue goes to the waiting ones
+void VmServer::collect() {
+    std::deque<Done> done;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done.swap(finished);
+    }
+
+    for (Done& entry : done) {
+        auto it = connections.find(entry.connection);
+
+        // the client left while its program was running
+        if (it == connections.end()) {
+            continue;
+        }
+        it->second.running = false;
+        it->second.unsent += entry.reply;
+        transmit(entry.connection, it->second);
+    }
+
+    while (!waiting.empty()) {
+        auto it = connections.find(waiting.front());
+
+        if (!dispatch(it->first, it->second)) {
+            return;
+        }
+        it->second.queued = false;
+        waiting.pop_front();
+        update(it->first, it->second);
+    }
+}
+
+void VmServer::update(uint64_t id, Connection& connection) {
+    // connections that waited for room go first
+    if (!connection.running && !connection.queued && hasRequest(connection)
+        && (!waiting.empty() || !dispatch(id, connection))) {
+        connection.queued = true;
+        waiting.push_back(id);
+    }
+
+    size_t pending = connection.unsent.size() - connection.sent;
+    if (connection.peerClosed && !connection.running && !connection.queued && !hasRequest(connection) && pending == 0) {
+        closeConnection(id);
+        return;
+    }
+
+    uint32_t events = 0;
+    if (!connection.peerClosed && !hasRequest(connection) && pending < MAX_UNSENT_BYTES) {
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events == connection.events) {
+        return;
+    }
+
+    // a hung up socket reports EPOLLHUP whatever its interest: it leaves epoll while it has nothing to write
+    if (connection.hungUp && events == 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    } else {
+        watch(epollFd, connection.hungUp && connection.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, connection.fd, id, events);
+    }
+    connection.events = events;
+}
+
+void VmServer::hangUp(uint64_t id, Connection& connection) {
+    if (!connection.hungUp) {
+        connection.hungUp = true;
+        connection.peerClosed = true;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        connection.events = 0;
+    }
+    transmit(id, connection);
+}
+
+bool VmServer::dispatch(uint64_t id, Connection& connection) {
+    RequestHeader header;
+    memcpy(&header, connection.input.data(), sizeof(header));
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (jobs.size() >= queueLimit) {
+            return false;
+        }
+        jobs.push_back({id, connection.input.substr(sizeof(header), header.sourceSize)});
+    }
+    ready.notify_one();
+
+    connection.input.erase(0, sizeof(header) + header.sourceSize);
+    connection.running = true;
+    return true;
+}
+
+void VmServer::closeConnection(uint64_t id) {
+    auto it = connections.find(id);
+
+    if (it == connections.end()) {
+        return;
+    }
+    // a stale entry in waiting would hold back the requests queued behind it
+    if (it->second.queued) {
+        waiting.erase(std::find(waiting.begin(), waiting.end(), id));
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    connections.erase(it);
+}
+
+static void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            throw SocketError();
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+static void readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = ::read(fd, data, size);
+
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        // the server closes a connection it cannot serve
+        if (got <= 0) {
+            throw SocketError();
+        }
+        data += got;
+        size -= got;
+    }
+}
+
+static std::string readString(int fd, size_t size) {
+    std::string text(size, '\0');
+    readAll(fd, &text[0], size);
+    return text;
+}
+
+VmClient::VmClient(const std::string& socketPath) {
+    sockaddr_un address = socketAddress(socketPath);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw SocketError();
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        throw SocketError();
+    }
+}
+
+VmClient::~VmClient() {
+    ::close(fd);
+}
+
+ServerReply VmClient::run(const std::string& source) {
+    send(source);
+    return receive();
+}
+
+void VmClient::send(const std::string& source) {
+    RequestHeader header = {static_cast<uint32_t>(source.size())};
+    std::string request;
+
+    if (source.size() > VmServer::MAX_SOURCE_SIZE) {
+        throw SocketError();
+    }
+
+    // one write per request, the server reads it in one go when it is small
+    request.reserve(sizeof(header) + source.size());
+    request.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    request += source;
+    writeAll(fd, request.data(), request.size());
+}
+
+ServerReply VmClient::receive() {
+    ReplyHeader header;
+    ServerReply reply;
+
+    readAll(fd, reinterpret_cast<char*>(&header), sizeof(header));
+    reply.result.status = static_cast<eRunStatus>(header.status);
+    reply.result.errorLine = header.errorLine;
+    reply.output = readString(fd, header.outputSize);
+    reply.stack = readString(fd, header.stackSize);
+    reply.result.error = readString(fd, header.errorSize);
+    return reply;
+}
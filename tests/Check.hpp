@@ -0,0 +1,35 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+    #include <iostream>
+
+    /*
+        Checks of the unit tests in tests/. A failed CHECK prints its condition and line and the
+        test goes on, main returns checkResult() so that make test stops on the first failed binary.
+    */
+    struct CheckCounts {
+        size_t  passed = 0;
+        size_t  failed = 0;
+    };
+
+    inline CheckCounts& checkCounts() {
+        static CheckCounts counts;
+        return counts;
+    }
+
+    #define CHECK(condition) \
+        do { \
+            if (condition) { \
+                checkCounts().passed++; \
+            } else { \
+                checkCounts().failed++; \
+                std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " << #condition << std::endl; \
+            } \
+        } while (0)
+
+    // Prints the counts under the name of the test, 0 if every check passed
+    inline int checkResult(const char* name) {
+        std::cout << name << ": " << checkCounts().passed << " passed, " << checkCounts().failed << " failed" << std::endl;
+        return checkCounts().failed ? 1 : 0;
+    }
+#endif
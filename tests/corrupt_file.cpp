@@ -0,0 +1,104 @@
+#include "../include/BytecodeFile.hpp"
+#include "../include/Snapshot.hpp"
+#include <stddef.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/*
+    Damages a .avmc or .avms file in place, for the rejection tests of run_tests.sh.
+    Usage: corrupt_file <file> <checksum|version|target|pc|return>
+        checksum    changes a byte after the header and leaves the checksum as it was
+        version     writes the next version of the format
+        target      sends the first jump of a .avmc past the end of the program
+        pc          sends the next instruction of a .avms past the end of the program
+        return      sends the first return address of a .avms past the end of the program
+    Except for checksum, the checksum is computed again, so only the field itself is wrong.
+*/
+
+static void sealBytecode(std::string& file) {
+    BytecodeHeader* header = reinterpret_cast<BytecodeHeader*>(&file[0]);
+
+    header->checksum = instructionChecksum(reinterpret_cast<const Instruction*>(&file[sizeof(BytecodeHeader)]), header->count);
+}
+
+static void sealSnapshot(std::string& file) {
+    SnapshotHeader* header = reinterpret_cast<SnapshotHeader*>(&file[0]);
+
+    header->checksum = wordHash(&file[sizeof(SnapshotHeader)], file.size() - sizeof(SnapshotHeader),
+                                wordHash(header, offsetof(SnapshotHeader, checksum)));
+}
+
+static bool corruptBytecode(std::string& file, const std::string& field) {
+    BytecodeHeader* header = reinterpret_cast<BytecodeHeader*>(&file[0]);
+    Instruction* code = reinterpret_cast<Instruction*>(&file[sizeof(BytecodeHeader)]);
+
+    if (field == "checksum" && header->count > 0) {
+        code[0].line ^= 1;
+        return true;
+    }
+    if (field == "version") {
+        header->version++;
+        return true;
+    }
+    if (field == "target") {
+        for (size_t i = 0; i < header->count; i++) {
+            if (isJump(code[i].opcode)) {
+                code[i].setTarget(header->count + 1);
+                sealBytecode(file);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool corruptSnapshot(std::string& file, const std::string& field) {
+    SnapshotHeader* header = reinterpret_cast<SnapshotHeader*>(&file[0]);
+
+    if (field == "checksum" && file.size() > sizeof(SnapshotHeader)) {
+        file.back() ^= 1;
+        return true;
+    }
+    if (field == "version") {
+        header->version++;
+    } else if (field == "pc") {
+        header->pc = UINT32_MAX;
+    } else if (field == "return" && header->callCount > 0) {
+        uint32_t returnTo = UINT32_MAX;
+
+        memcpy(&file[sizeof(SnapshotHeader) + header->segmentCount * sizeof(SnapshotSegment)], &returnTo, sizeof(returnTo));
+    } else {
+        return false;
+    }
+    sealSnapshot(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: corrupt_file <file> <checksum|version|target|pc|return>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream infile(argv[1], std::ios::binary);
+    std::stringstream content;
+    content << infile.rdbuf();
+    std::string file = content.str();
+
+    bool done = false;
+    if (file.size() >= sizeof(SnapshotHeader) && file.compare(0, 4, "AVMS") == 0) {
+        done = corruptSnapshot(file, argv[2]);
+    } else if (file.size() >= sizeof(BytecodeHeader) && file.compare(0, 4, "AVMC") == 0) {
+        done = corruptBytecode(file, argv[2]);
+    }
+    if (!done) {
+        std::cerr << argv[1] << ": can not change " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::ofstream outfile(argv[1], std::ios::binary | std::ios::trunc);
+    outfile.write(file.data(), file.size());
+    return outfile ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#!/bin/sh
+#
+# Runs every program of tests/programs and compares what it prints with the .out (stdout) and .err
+# (stderr) files next to it. A program with an expected error must also exit with a failure status.
+# Each program also runs on its register form, in stream mode and from a .avmc, which must all give
+# the same output and errors.
+# Then runs them all as one batch, checks that a checkpoint resumes to the same output, and that
+# damaged .avmc and .avms files are rejected.
+# Usage, from the root of the repository: tests/run_tests.sh [my_abstract_vm] [corrupt_file]
+
+# the batch runner sorts its files bytewise, like the globs below
+export LC_ALL=C
+
+VM=${1:-./my_abstract_vm}
+CORRUPT=${2:-obj/corrupt_file}
+PROGRAMS=tests/programs
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+passed=0
+failed=0
+
+# check <name> <expected stdout> <expected stderr> <command...>
+check() {
+    name=$1
+    out=$2
+    err=$3
+    shift 3
+
+    "$@" > "$WORK/stdout" 2> "$WORK/stderr"
+    status=$?
+    expected=0
+    if [ -s "$err" ]; then
+        expected=1
+    fi
+
+    if [ $status -eq $expected ] && cmp -s "$out" "$WORK/stdout" && cmp -s "$err" "$WORK/stderr"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+        echo "FAIL $name: exit status $status, expected $expected"
+        diff "$out" "$WORK/stdout"
+        diff "$err" "$WORK/stderr"
+    fi
+}
+
+# Output of a run stopped after the line, then of its resume
+checkpointed() {
+    "$VM" --checkpoint "$1" "$2" "$WORK/state.avms" && "$VM" --resume "$1" "$WORK/state.avms"
+}
+
+# The last line of a batch ends with its time, which is dropped
+batched() {
+    "$VM" --batch "$@" 2> "$WORK/batch.stderr"
+    status=$?
+    sed 's/ threads, .*s$/ threads/' "$WORK/batch.stderr" >&2
+    return $status
+}
+
+compiled() {
+    "$VM" --compile "$1" "$WORK/program.avmc" && "$VM" "$WORK/program.avmc"
+}
+
+# corrupted <file> <field> <copy>: the copy of the file with the field damaged
+corrupted() {
+    cp "$1" "$3" && "$CORRUPT" "$3" "$2"
+}
+
+for program in "$PROGRAMS"/*.avm; do
+    base=${program%.avm}
+    name=$(basename "$program")
+
+    check "$name" "$base.out" "$base.err" "$VM" "$program"
+    check "$name --registers" "$base.out" "$base.err" "$VM" --registers "$program"
+    check "$name --stream" "$base.out" "$base.err" "$VM" --stream "$program"
+    check "$name .avmc" "$base.out" "$base.err" compiled "$program"
+done
+
+# the batch prints every output in input order, the errors with the name of their program, then counts them
+: > "$WORK/batch.out"
+: > "$WORK/batch.err"
+programs=0
+errors=0
+for program in "$PROGRAMS"/*.avm; do
+    base=${program%.avm}
+    programs=$((programs + 1))
+
+    echo "==> $program" >> "$WORK/batch.out"
+    cat "$base.out" >> "$WORK/batch.out"
+    if [ -s "$base.err" ]; then
+        errors=$((errors + 1))
+        printf '%s: ' "$program" >> "$WORK/batch.err"
+        cat "$base.err" >> "$WORK/batch.err"
+    fi
+done
+echo "$programs programs, $errors failed, 2 threads" >> "$WORK/batch.err"
+check "--batch -j 2" "$WORK/batch.out" "$WORK/batch.err" batched "$PROGRAMS" -j 2
+
+# the snapshot is taken in the second call of quadruple, with two calls in progress
+check "call_ret.avm --checkpoint" "$PROGRAMS/call_ret.out" "$PROGRAMS/call_ret.err" checkpointed "$PROGRAMS/call_ret.avm" 10
+
+: > "$WORK/empty"
+echo "Error: Invalid option, -j takes 1 to 1024 threads, --prefix-cache 1 to 65536 MB and --checkpoint a line from 1" > "$WORK/option.err"
+for line in abc -1 0 12x 99999999999999999999; do
+    check "--checkpoint line $line" "$WORK/empty" "$WORK/option.err" "$VM" --checkpoint "$PROGRAMS/call_ret.avm" "$line" "$WORK/state.avms"
+done
+echo "Error: Invalid or corrupted bytecode file" > "$WORK/bytecode.err"
+echo "Error: Invalid or corrupted snapshot, or snapshot of another program" > "$WORK/snapshot.err"
+
+"$VM" --compile "$PROGRAMS/conditional_jumps.avm" "$WORK/good.avmc"
+for field in checksum version target; do
+    if corrupted "$WORK/good.avmc" $field "$WORK/bad.avmc"; then
+        check "bad .avmc $field" "$WORK/empty" "$WORK/bytecode.err" "$VM" "$WORK/bad.avmc"
+    else
+        failed=$((failed + 1))
+    fi
+done
+
+"$VM" --checkpoint "$PROGRAMS/call_ret.avm" 10 "$WORK/good.avms"
+for field in checksum version pc return; do
+    if corrupted "$WORK/good.avms" $field "$WORK/bad.avms"; then
+        check "bad .avms $field" "$WORK/empty" "$WORK/snapshot.err" "$VM" --resume "$PROGRAMS/call_ret.avm" "$WORK/bad.avms"
+    else
+        failed=$((failed + 1))
+    fi
+done
+check ".avms of another program" "$WORK/empty" "$WORK/snapshot.err" "$VM" --resume "$PROGRAMS/conditional_jumps.avm" "$WORK/good.avms"
+
+echo "$passed passed, $failed failed"
+[ $failed -eq 0 ]
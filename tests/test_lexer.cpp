@@ -0,0 +1,141 @@
+#include "./Check.hpp"
+#include "../include/Lexer.hpp"
+#include <map>
+
+// Every mnemonic is recognized as its opcode, and every word one letter away from one as nothing else
+static void testInstructions() {
+    std::map<std::string, eInstructionType> mnemonics;
+    for (uint8_t opcode = Push; opcode < PushAdd; opcode++) {
+        if (opcode != Nil) {
+            mnemonics[instructionName(opcode)] = static_cast<eInstructionType>(opcode);
+        }
+    }
+
+    for (const auto& mnemonic : mnemonics) {
+        eInstructionType type = Nil;
+        CHECK(matchInstruction(mnemonic.first, type) && type == mnemonic.second);
+
+        for (size_t i = 0; i < mnemonic.first.size(); i++) {
+            for (char c = 'a'; c <= 'z'; c++) {
+                std::string word = mnemonic.first;
+                word[i] = c;
+
+                auto known = mnemonics.find(word);
+                bool matched = matchInstruction(word, type);
+                CHECK(matched == (known != mnemonics.end()));
+                CHECK(!matched || type == known->second);
+            }
+            // "add" is both a prefix of "addn" and a mnemonic
+            std::string prefix = mnemonic.first.substr(0, i);
+            CHECK(matchInstruction(prefix, type) == (mnemonics.count(prefix) == 1));
+        }
+        CHECK(!matchInstruction(mnemonic.first + "s", type));
+    }
+
+    eInstructionType type = Push;
+    CHECK(matchInstruction(";", type) && type == Nil);
+    CHECK(!matchInstruction("PUSH", type));
+    CHECK(!matchInstruction("push+add", type));
+}
+
+static void testOperandTypes() {
+    const char* names[] = { "int8", "int16", "int32", "float", "double" };
+    eOperandType type = Int8;
+
+    for (int expected = Int8; expected <= Double; expected++) {
+        CHECK(matchOperandType(names[expected], type) && type == expected);
+    }
+    CHECK(!matchOperandType("int64", type));
+    CHECK(!matchOperandType("int", type));
+    CHECK(!matchOperandType("floa", type));
+    CHECK(!matchOperandType("doubles", type));
+    CHECK(!matchOperandType("Int8", type));
+    CHECK(!matchOperandType("", type));
+}
+
+// True if tokenizing the line throws E
+template <typename E>
+static bool rejects(std::string_view line) {
+    try {
+        tokenizeLine(line);
+    } catch (const E&) {
+        return true;
+    }
+    return false;
+}
+
+// The tokens are slices of the line itself
+static void testTokenizer() {
+    std::string line = "  push int32(-42) ; the answer";
+    LineTokens tokens = tokenizeLine(line);
+    CHECK(tokens.instruction == Push);
+    CHECK(tokens.hasOperand && tokens.type == "int32" && tokens.value == "-42");
+    CHECK(tokens.value.data() == line.data() + 13);
+    CHECK(tokens.label.empty());
+
+    tokens = tokenizeLine("loop: assert double(1.5)");
+    CHECK(tokens.label == "loop" && tokens.instruction == Assert && tokens.type == "double" && tokens.value == "1.5");
+
+    tokens = tokenizeLine("end_2:");
+    CHECK(tokens.label == "end_2" && tokens.instruction == Nil);
+
+    tokens = tokenizeLine("jlt loop\r");
+    CHECK(tokens.instruction == Jlt && tokens.target == "loop" && !tokens.hasOperand);
+
+    CHECK(tokenizeLine(";; end").instruction == Exit);
+    CHECK(tokenizeLine("; comment").instruction == Nil);
+    CHECK(tokenizeLine("").instruction == Nil);
+    CHECK(tokenizeLine(" \t ").instruction == Nil);
+    CHECK(tokenizeLine("pop ; comment").instruction == Pop);
+
+    CHECK(rejects<InvalidInstruction>("foo"));
+    CHECK(rejects<InvalidInstruction>("9loop: pop"));
+    CHECK(rejects<InvalidInstruction>("lo-op: pop"));
+    CHECK(rejects<InvalidOperandType>("jmp 9loop"));
+    CHECK(rejects<InvalidOperandType>("call"));
+    CHECK(rejects<InvalidOperandType>("push int32(42"));
+    CHECK(rejects<InvalidOperandType>("push int32(4a)"));
+    CHECK(rejects<InvalidOperandType>("push int32(1.2.3)"));
+    CHECK(rejects<InvalidOperandType>("push int32(42) int32(1)"));
+}
+
+// True if parsing the literal throws E
+template <typename E>
+static bool parseRejects(eOperandType type, std::string_view literal) {
+    try {
+        parseValue(type, literal);
+    } catch (const E&) {
+        return true;
+    }
+    return false;
+}
+
+// Numbers are parsed in place, and checked against the range of their type
+static void testNumbers() {
+    Value value = parseValue(Int16, "-300");
+    CHECK(value.type == Int16 && value.toString() == "-300");
+    CHECK(parseValue(Int8, "127").toString() == "127");
+    CHECK(parseValue(Int8, "-128").toString() == "-128");
+    CHECK(parseValue(Int32, "2147483647").toString() == "2147483647");
+    CHECK(parseValue(Double, "0.25").toString() == "0.25");
+    CHECK(parseValue(Float, "-1.5").type == Float);
+
+    CHECK(parseRejects<Overflow>(Int8, "128"));
+    CHECK(parseRejects<Underflow>(Int8, "-129"));
+    CHECK(parseRejects<Underflow>(Int16, "-32769"));
+    CHECK(parseRejects<Overflow>(Int32, "2147483648"));
+    CHECK(parseRejects<Overflow>(Int32, "99999999999999999999"));
+    CHECK(parseRejects<Overflow>(Float, "1000000000000000000000000000000000000000"));
+    CHECK(!parseRejects<Overflow>(Double, "1000000000000000000000000000000000000000"));
+
+    // too small to be told from zero is zero
+    CHECK(parseValue(Double, "0." + std::string(400, '0') + "1").toString() == "0");
+}
+
+int main() {
+    testInstructions();
+    testOperandTypes();
+    testTokenizer();
+    testNumbers();
+    return checkResult("test_lexer");
+}
@@ -0,0 +1,72 @@
+#include "./Check.hpp"
+#include "../include/MyAbstractVm.hpp"
+#include "../include/Compiler.hpp"
+#include <stdio.h>
+#include <unistd.h>
+
+// Writes smaller and bigger than the buffer, one by one and in blocks, come out whole and in order
+static void testMemorySink() {
+    MemorySink sink(4);
+
+    sink.write("ab", 2);
+    sink.put('c');
+    sink.write(std::string("defghij"));
+    sink.put('k');
+    CHECK(sink.position() == 11);
+    CHECK(sink.str() == "abcdefghijk");
+
+    sink.clear();
+    sink.write("xyz", 3);
+    CHECK(sink.str() == "xyz");
+    CHECK(sink.position() == 14);
+
+    // a restored snapshot goes on from the position of the program
+    sink.setPosition(100);
+    sink.put('!');
+    CHECK(sink.position() == 101);
+    CHECK(sink.str() == "xyz!");
+}
+
+// Nothing reaches the descriptor before a flush, everything has once the sink is destroyed
+static void testFdSink() {
+    int pipeFds[2];
+    CHECK(pipe(pipeFds) == 0);
+
+    char text[16] = {};
+    {
+        FdSink sink(pipeFds[1], 8);
+
+        sink.write("hello", 5);
+        CHECK(sink.position() == 5);
+        sink.write(" world", 6);
+    }
+    close(pipeFds[1]);
+
+    ssize_t size = read(pipeFds[0], text, sizeof(text) - 1);
+    close(pipeFds[0]);
+    CHECK(size == 11);
+    CHECK(std::string(text) == "hello world");
+}
+
+// The VM prints through the sink it was given, the output of a program that fails included
+static void testVmOutput() {
+    Compiler compiler;
+    MyAbstractVM vm;
+    MemorySink sink;
+
+    vm.setOutput(sink);
+    Program program = compiler.compileBuffer("push int32(42)\ndump\npush int32(0)\npush int32(1)\ndiv\nexit\n", 1);
+    try {
+        vm.run(program.data(), program.size());
+        CHECK(false);
+    } catch (const std::exception&) {
+    }
+    CHECK(sink.str() == "42\n");
+}
+
+int main() {
+    testMemorySink();
+    testFdSink();
+    testVmOutput();
+    return checkResult("test_output_sink");
+}
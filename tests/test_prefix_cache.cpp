@@ -0,0 +1,82 @@
+#include "./Check.hpp"
+#include "../include/VmInstance.hpp"
+
+static const size_t INTERVAL = 16;
+
+// A prefix of 200 instructions with a dump halfway, then the end. It is not optimized, which would fold it
+static Program prefixed(const std::string& first, const std::string& end) {
+    std::string source = first;
+
+    for (int i = 0; i < 100; i++) {
+        source += i == 50 ? "dump\n" : "push int32(1)\nadd\n";
+    }
+    Compiler compiler;
+    return compiler.compileBuffer(source + end, 1);
+}
+
+struct Outcome {
+    RunResult   result;
+    std::string output;
+    std::string top;
+};
+
+static Outcome run(const Program& program, PrefixCache* cache) {
+    VmInstance vm;
+    Outcome outcome;
+
+    vm.setPrefixCache(cache);
+    vm.loadProgram(program);
+    outcome.result = vm.run();
+    outcome.output = vm.output();
+    outcome.top = vm.stack().size() ? vm.stack().top().toString() : "";
+    return outcome;
+}
+
+// A program that shares its prefix with an earlier one resumes from it, and ends like a full run
+static void testResume() {
+    PrefixCache cache(1 << 20, INTERVAL);
+    Program first = prefixed("push int32(0)\n", "push int32(7)\nmul\ndump\nexit\n");
+    Program second = prefixed("push int32(0)\n", "push int32(3)\nsub\ndump\nexit\n");
+    Program other = prefixed("push int32(5)\n", "push int32(3)\nsub\ndump\nexit\n");
+
+    Outcome expected = run(second, nullptr);
+    CHECK(expected.result.status == Exited);
+
+    run(first, &cache);
+    PrefixCache::Stats stats = cache.stats();
+    CHECK(stats.hits == 0);
+    CHECK(stats.misses == 1);
+    CHECK(stats.stores > 0);
+
+    Outcome resumed = run(second, &cache);
+    stats = cache.stats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.skipped > INTERVAL && stats.skipped <= first.size() && stats.skipped % INTERVAL == 0);
+    CHECK(resumed.result.status == Exited);
+    CHECK(resumed.output == expected.output);
+    CHECK(resumed.top == expected.top);
+
+    // the first instruction differs, no checkpoint applies
+    Outcome unrelated = run(other, &cache);
+    CHECK(cache.stats().hits == 1);
+    CHECK(unrelated.output == run(other, nullptr).output);
+}
+
+// The cache stays within its budget by dropping the least recently used checkpoints
+static void testBudget() {
+    PrefixCache cache(8 * 1024, INTERVAL);
+
+    for (int i = 0; i < 20; i++) {
+        run(prefixed("push int32(" + std::to_string(i) + ")\n", "exit\n"), &cache);
+    }
+    PrefixCache::Stats stats = cache.stats();
+    CHECK(stats.stores > 0);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.bytes <= cache.budget());
+}
+
+int main() {
+    testResume();
+    testBudget();
+    return checkResult("test_prefix_cache");
+}
@@ -0,0 +1,73 @@
+#include "./Check.hpp"
+#include "../include/MyAbstractVm.hpp"
+#include "../include/Compiler.hpp"
+#include <sstream>
+
+// Counts of a loop run unoptimized: 100 turns of lines 2 to 6
+static void testCounts() {
+    Compiler compiler;
+    MyAbstractVM vm;
+    MemorySink output;
+    Profiler profiler;
+
+    Program program = compiler.compileBuffer("push int32(0)\nloop: push int32(1)\nadd\ndup\npush int32(100)\njne loop\nexit\n", 1);
+    vm.setOutput(output);
+    vm.setProfiler(&profiler);
+    CHECK(vm.run(program.data(), program.size()) == Exited);
+
+    CHECK(profiler.opcode(Push).count == 201);
+    CHECK(profiler.opcode(Add).count == 100);
+    CHECK(profiler.opcode(Dup).count == 100);
+    CHECK(profiler.opcode(Jne).count == 100);
+    CHECK(profiler.opcode(Exit).count == 1);
+    CHECK(profiler.opcode(Mul).count == 0);
+    CHECK(profiler.lineHits(1) == 1);
+    CHECK(profiler.lineHits(2) == 100);
+    CHECK(profiler.lineHits(7) == 1);
+    CHECK(profiler.lineHits(8) == 0);
+    CHECK(profiler.peakStackDepth() == 3);
+    CHECK(profiler.opcode(Add).nanoseconds >= profiler.opcode(Add).averageNanoseconds());
+}
+
+// Every growth of the stack is charged to the push that needed it, and shows in both reports
+static void testStackGrowths() {
+    std::string source;
+    for (int i = 0; i < 1000; i++) {
+        source += "push int32(1)\n";
+    }
+    source += "add\nexit\n";
+
+    Compiler compiler;
+    MyAbstractVM vm(64);
+    MemorySink output;
+    Profiler profiler;
+
+    Program program = compiler.compileBuffer(source, 1);
+    vm.setOutput(output);
+    vm.setProfiler(&profiler);
+    vm.run(program.data(), program.size());
+
+    CHECK(vm.getStack().growths() > 0);
+    CHECK(profiler.opcode(Push).stackGrowths == vm.getStack().growths());
+    CHECK(profiler.opcode(Add).stackGrowths == 0);
+    CHECK(profiler.peakStackDepth() == 1000);
+
+    std::ostringstream table;
+    profiler.writeTable(table);
+    CHECK(table.str().find("stack growths") != std::string::npos);
+    CHECK(table.str().find("peak stack depth: 1000") != std::string::npos);
+
+    std::ostringstream json;
+    profiler.writeJson(json);
+    std::string expected = "\"push\": {\"count\": 1000, ";
+    CHECK(json.str().find(expected) != std::string::npos);
+    expected = "\"stack_growths\": " + std::to_string(vm.getStack().growths()) + "}";
+    CHECK(json.str().find(expected) != std::string::npos);
+    CHECK(json.str().find("\"peak_stack_depth\": 1000") != std::string::npos);
+}
+
+int main() {
+    testCounts();
+    testStackGrowths();
+    return checkResult("test_profiler");
+}
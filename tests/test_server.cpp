@@ -0,0 +1,114 @@
+#include "./Check.hpp"
+#include "../include/VmServer.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// The socket is only opened by run(), clients retry until it is there
+static std::unique_ptr<VmClient> connectClient(const std::string& socketPath) {
+    for (int attempt = 0; attempt < 2000; attempt++) {
+        try {
+            return std::unique_ptr<VmClient>(new VmClient(socketPath));
+        } catch (const SocketError&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return nullptr;
+}
+
+static std::string counterProgram(int i) {
+    return "push int32(" + std::to_string(i) + ")\ndump\nexit\n";
+}
+
+// One program, then pipelined ones that come back in order, a failing one among them
+static void testReplies(const std::string& socketPath) {
+    std::unique_ptr<VmClient> client = connectClient(socketPath);
+    CHECK(client != nullptr);
+    if (!client) {
+        return;
+    }
+
+    ServerReply reply = client->run("push int32(42)\npush int32(33)\nadd\nexit\n");
+    CHECK(reply.result.status == Exited);
+    CHECK(reply.output == "Exiting program...\n");
+    CHECK(reply.stack == "75\n");
+
+    for (int i = 0; i < 20; i++) {
+        client->send(i == 7 ? "push int32(1)\ndump\npop\nadd\nexit\n" : counterProgram(i));
+    }
+    for (int i = 0; i < 20; i++) {
+        reply = client->receive();
+        if (i == 7) {
+            CHECK(reply.result.status == Failed);
+            CHECK(reply.result.errorLine == 4);
+            CHECK(reply.result.error.find("Less than two values") != std::string::npos);
+            CHECK(reply.output == "1\n");
+        } else {
+            CHECK(reply.result.status == Exited);
+            CHECK(reply.output == std::to_string(i) + "\nExiting program...\n");
+        }
+    }
+}
+
+// A client that stops sending still gets the replies of everything it sent
+static void testHalfClosed(const std::string& socketPath) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    CHECK(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+    std::string requests;
+    for (int i = 0; i < 5; i++) {
+        std::string source = counterProgram(i);
+        RequestHeader header = {static_cast<uint32_t>(source.size())};
+
+        requests.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        requests += source;
+    }
+    CHECK(write(fd, requests.data(), requests.size()) == static_cast<ssize_t>(requests.size()));
+    shutdown(fd, SHUT_WR);
+
+    std::string received;
+    char buffer[4096];
+    ssize_t got;
+    while ((got = read(fd, buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, got);
+    }
+    close(fd);
+
+    size_t offset = 0;
+    int replies = 0;
+    while (offset + sizeof(ReplyHeader) <= received.size()) {
+        ReplyHeader header;
+        memcpy(&header, received.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        CHECK(received.compare(offset, header.outputSize, std::to_string(replies) + "\nExiting program...\n") == 0);
+        offset += header.outputSize + header.stackSize + header.errorSize;
+        replies++;
+    }
+    CHECK(replies == 5);
+    CHECK(offset == received.size());
+}
+
+int main() {
+    std::string socketPath = "/tmp/test_server_" + std::to_string(getpid()) + ".sock";
+    VmServer server(socketPath, 2);
+
+    // a server that stopped serves again on the next run()
+    for (int round = 0; round < 2; round++) {
+        std::thread serving([&server] { server.run(); });
+
+        testReplies(socketPath);
+        testHalfClosed(socketPath);
+
+        server.stop();
+        serving.join();
+        CHECK(access(socketPath.c_str(), F_OK) != 0);
+    }
+    return checkResult("test_server");
+}
@@ -0,0 +1,92 @@
+#include "./Check.hpp"
+#include "../include/VectorKernels.hpp"
+#include <string.h>
+#include <random>
+#include <vector>
+
+/*
+    Every kernel level the CPU supports against a plain loop that follows the contract of
+    VectorKernels, bit for bit, on every length up to a few vectors and on unaligned starts.
+*/
+static const size_t MAX_COUNT = 67;
+static const size_t MAX_OFFSET = 4;
+
+static IntSummary referenceSum(const int32_t* values, size_t count) {
+    IntSummary summary = {0, 0};
+
+    for (size_t i = 0; i < count; i++) {
+        summary.sum += values[i];
+        if (values[i] < 0) {
+            summary.negative += values[i];
+        }
+    }
+    return summary;
+}
+
+// Lane k adds the values k, k + 4, ... and the lanes are combined as (0 + 1) + (2 + 3)
+static double referenceSum(const double* values, size_t count) {
+    double lanes[4] = {0, 0, 0, 0};
+
+    for (size_t i = 0; i < count; i++) {
+        lanes[i % 4] += values[i];
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+static bool sameBits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static void testLevel(const VectorKernels& kernels, std::mt19937& random) {
+    std::uniform_int_distribution<int32_t> anyInt(INT32_MIN, INT32_MAX);
+    std::uniform_real_distribution<double> anyDouble(-1e6, 1e6);
+    std::vector<int32_t> ints(MAX_COUNT + MAX_OFFSET);
+    std::vector<double> lhs(MAX_COUNT + MAX_OFFSET);
+    std::vector<double> rhs(MAX_COUNT + MAX_OFFSET);
+    std::vector<double> products(MAX_COUNT + MAX_OFFSET);
+    size_t failures = checkCounts().failed;
+
+    for (size_t count = 0; count <= MAX_COUNT; count++) {
+        for (size_t offset = 0; offset < MAX_OFFSET; offset++) {
+            for (size_t i = 0; i < ints.size(); i++) {
+                ints[i] = anyInt(random);
+                // magnitudes far apart, so that another order of the additions gives other bits
+                lhs[i] = anyDouble(random) * (i % 3 == 0 ? 1e-9 : 1.0);
+                rhs[i] = anyDouble(random);
+            }
+
+            IntSummary expected = referenceSum(ints.data() + offset, count);
+            IntSummary summary = kernels.sumInt32(ints.data() + offset, count);
+            CHECK(summary.sum == expected.sum && summary.negative == expected.negative);
+
+            CHECK(sameBits(kernels.sumDouble(lhs.data() + offset, count), referenceSum(lhs.data() + offset, count)));
+
+            kernels.mulDouble(lhs.data() + offset, rhs.data() + offset, products.data() + offset, count);
+            for (size_t i = offset; i < offset + count; i++) {
+                CHECK(sameBits(products[i], lhs[i] * rhs[i]));
+            }
+        }
+    }
+
+    // the extremes of int32 do not wrap in the accumulators
+    std::vector<int32_t> extremes(MAX_COUNT, INT32_MIN);
+    CHECK(kernels.sumInt32(extremes.data(), MAX_COUNT).sum == int64_t(INT32_MIN) * int64_t(MAX_COUNT));
+    extremes.assign(MAX_COUNT, INT32_MAX);
+    CHECK(kernels.sumInt32(extremes.data(), MAX_COUNT).positive() == int64_t(INT32_MAX) * int64_t(MAX_COUNT));
+
+    if (checkCounts().failed != failures) {
+        std::cerr << "in the " << kernels.name << " kernels" << std::endl;
+    }
+}
+
+int main() {
+    std::mt19937 random(42);
+
+    for (int level = VectorKernels::Scalar; level <= VectorKernels::supportedLevel(); level++) {
+        const VectorKernels& kernels = VectorKernels::forLevel(static_cast<VectorKernels::eLevel>(level));
+
+        CHECK(kernels.level == level);
+        testLevel(kernels, random);
+    }
+    return checkResult("test_vector_kernels");
+}
@@ -0,0 +1,138 @@
+#include "./Check.hpp"
+#include "../include/VmInstance.hpp"
+#include <stdlib.h>
+#include <unistd.h>
+
+// The example of the header: run, final stack and output, then reset for the next program
+static void testRunAndReset() {
+    VmInstance vm;
+
+    vm.loadSource("push int32(42)\npush int32(33)\nadd\nexit\n");
+    RunResult result = vm.run();
+    CHECK(result.status == Exited);
+    CHECK(result.error.empty());
+    CHECK(vm.stack().size() == 1);
+    CHECK(vm.stack().top().type == Int32);
+    CHECK(vm.stack().top().toString() == "75");
+    CHECK(vm.output() == "Exiting program...\n");
+
+    vm.reset();
+    CHECK(vm.stack().size() == 0);
+    CHECK(vm.output().empty());
+
+    vm.loadSource("push double(1.5)\ndump\nexit\n");
+    CHECK(vm.run().status == Exited);
+    CHECK(vm.output() == "1.5\nExiting program...\n");
+}
+
+// Errors come back in the result, with their line, and the stack is left as the error found it
+static void testErrors() {
+    VmInstance vm;
+
+    vm.loadSource("push int32(1)\ndump\npush int32(0)\npush int32(7)\nmod\nexit\n");
+    RunResult result = vm.run();
+    CHECK(result.status == Failed);
+    CHECK(result.errorLine == 5);
+    CHECK(result.error.find("Division by zero") != std::string::npos);
+    CHECK(vm.output() == "1\n");
+
+    vm.reset();
+    vm.loadSource("push int32(1)\n");
+    result = vm.run();
+    CHECK(result.status == Failed);
+    CHECK(result.errorLine == 0);
+
+    // a compile error throws and keeps the program loaded before
+    vm.reset();
+    vm.loadSource("push int8(5)\nexit\n");
+    bool thrown = false;
+    try {
+        vm.loadSource("push int8(5)\nfoo\nexit\n");
+    } catch (const ProgramError& error) {
+        thrown = error.line() == 2;
+    }
+    CHECK(thrown);
+    CHECK(vm.run().status == Exited);
+    CHECK(vm.stack().top().toString() == "5");
+}
+
+// A push and its operation are fused by the optimizer, when the operation fails the stack is the one they leave unfused
+static void testFusedOperationError() {
+    const char* sources[] = {
+        "push int32(5)\nadd\nexit\n",
+        "push int32(0)\ndump\npush int32(7)\ndiv\nexit\n",
+        "push int8(100)\ndump\npush int8(100)\nadd\nexit\n",
+        "push float(0)\ndump\npush double(1.5)\nmod\nexit\n",
+    };
+
+    for (const char* source : sources) {
+        Compiler compiler;
+        VmInstance fused;
+        VmInstance unfused;
+
+        fused.loadSource(source);
+        unfused.loadProgram(compiler.compileBuffer(source, 1));
+        RunResult fusedResult = fused.run();
+        RunResult unfusedResult = unfused.run();
+
+        CHECK(fusedResult.status == Failed);
+        CHECK(fusedResult.error == unfusedResult.error);
+        CHECK(fusedResult.errorLine == unfusedResult.errorLine);
+        CHECK(fused.stack().size() == unfused.stack().size());
+        for (size_t i = 0; i < fused.stack().size() && i < unfused.stack().size(); i++) {
+            CHECK(fused.stack()[i].type == unfused.stack()[i].type);
+            CHECK(fused.stack()[i].toString() == unfused.stack()[i].toString());
+        }
+    }
+}
+
+// A checkpoint taken by runTo goes on in another instance with the same output as a single run
+static void testCheckpoint() {
+    const char* source = "push int32(2)\ndup\nmul\ndump\ndup\nmul\ndump\nexit\n";
+    VmInstance whole;
+    VmInstance first;
+    VmInstance second;
+
+    whole.loadSource(source);
+    whole.run();
+
+    first.loadSource(source);
+    CHECK(first.runTo(4).status == Completed);
+    std::string state = first.checkpoint();
+
+    second.loadSource(source);
+    second.restore(state.data(), state.size());
+    CHECK(second.run().status == Exited);
+    CHECK(first.output() + second.output() == whole.output());
+    CHECK(second.outputPosition() == whole.outputPosition());
+    CHECK(second.stack().top().toString() == "16");
+}
+
+// A .avmc file runs like its source
+static void testCompiledFile() {
+    char fileName[] = "/tmp/test_vm_instance_XXXXXX";
+    int fd = mkstemp(fileName);
+    CHECK(fd >= 0);
+    close(fd);
+
+    Compiler compiler;
+    Optimizer optimizer;
+    Program program = compiler.compileBuffer("push int16(300)\npush int8(2)\nmul\ndump\nexit\n", 1);
+    BytecodeFile::write(fileName, optimizer.optimize(program));
+
+    VmInstance vm;
+    vm.loadFile(fileName);
+    CHECK(vm.run().status == Exited);
+    CHECK(vm.output() == "600\nExiting program...\n");
+    CHECK(vm.stack().top().type == Int16);
+    unlink(fileName);
+}
+
+int main() {
+    testRunAndReset();
+    testErrors();
+    testFusedOperationError();
+    testCheckpoint();
+    testCompiledFile();
+    return checkResult("test_vm_instance");
+}